@@ -0,0 +1,105 @@
+#include "PCH.h"
+
+#include "Core/JobSystem.h"
+
+#include <cstdio>
+#include <limits>
+
+// Measures the fixed costs of the job system, so the tasks themselves do next to nothing
+using Clock = std::chrono::steady_clock;
+
+template<typename Func>
+f64 Measure(u32 repeats, Func&& func)
+{
+	f64 best = std::numeric_limits<f64>::max();
+	for (u32 i = 0; i < repeats; i++)
+	{
+		auto start = Clock::now();
+		func();
+		best = std::min(best, std::chrono::duration<f64, std::nano>(Clock::now() - start).count());
+	}
+
+	return best;
+}
+
+// Every task is spawned by the calling thread, so with more than one worker nearly all of them are stolen
+f64 SpawnChildren(u32 count)
+{
+	std::atomic<u32> sink = 0;
+	return Measure(10, [&]() {
+		Jobs::TaskHandle root = Jobs::Create(nullptr);
+		for (u32 i = 0; i < count; i++)
+		{
+			Jobs::Submit(Jobs::Create([&sink]() { sink.fetch_add(1, std::memory_order_relaxed); }, &root));
+		}
+		Jobs::Submit(root);
+		Jobs::Wait(root);
+	}) / count;
+}
+
+// Each task can only run once the previous one has finished
+f64 Chain(u32 count)
+{
+	return Measure(10, [&]() {
+		Jobs::TaskHandle first = Jobs::Create(nullptr);
+		Jobs::TaskHandle last = first;
+		for (u32 i = 1; i < count; i++)
+		{
+			Jobs::TaskHandle next = Jobs::Create(nullptr);
+			Jobs::DependsOn(next, last);
+			Jobs::Submit(last);
+			last = std::move(next);
+		}
+		Jobs::Submit(last);
+		Jobs::Wait(last);
+	}) / count;
+}
+
+f64 ParallelFor(u64 count, u64 grain, std::vector<f32>& data)
+{
+	return Measure(10, [&]() {
+		Jobs::ParallelFor(0, count, grain, [&](u64 begin, u64 end) {
+			for (u64 i = begin; i < end; i++)
+			{
+				data[i] = data[i] * 0.5f + 1.f;
+			}
+		});
+	});
+}
+
+int main(int argc, char* argv[])
+{
+	Logger::Init();
+
+	u32 maxWorkers = argc > 1 ? u32(std::atoi(argv[1])) : std::thread::hardware_concurrency();
+	maxWorkers = std::max(maxWorkers, 1u);
+
+	constexpr u32 TaskCount = 100000;
+	constexpr u64 ElementCount = 1 << 22;
+	std::vector<f32> data(ElementCount, 1.f);
+
+	std::vector<u32> workerCounts;
+	for (u32 workers = 1; workers < maxWorkers; workers *= 2)
+	{
+		workerCounts.push_back(workers);
+	}
+	workerCounts.push_back(maxWorkers);
+
+	std::printf("%8s %14s %14s %16s %16s\n", "Workers", "Spawn (ns)", "Chain (ns)", "For 1K (us)", "For 64K (us)");
+	for (u32 workers : workerCounts)
+	{
+		Jobs::Init(workers);
+
+		f64 spawn = SpawnChildren(TaskCount);
+		f64 chain = Chain(TaskCount);
+		f64 smallGrain = ParallelFor(ElementCount, 1024, data) / 1000.0;
+		f64 largeGrain = ParallelFor(ElementCount, 65536, data) / 1000.0;
+		std::printf("%8u %14.1f %14.1f %16.1f %16.1f\n", workers, spawn, chain, smallGrain, largeGrain);
+
+		Jobs::Cleanup();
+	}
+
+	Logger::Cleanup();
+
+	return 0;
+}
@@ -0,0 +1,17 @@
+#version 450
+
+layout(push_constant) uniform Screen
+{
+	vec2 Size;
+} Target;
+
+layout(location = 0) in vec2 InPosition;
+layout(location = 1) in vec4 InColor;
+
+layout(location = 0) out vec4 OutColor;
+
+void main()
+{
+	gl_Position = vec4(InPosition / Target.Size * 2.f - 1.f, 0.f, 1.f);
+	OutColor = InColor;
+}
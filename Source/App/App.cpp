@@ -7,19 +7,89 @@
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 
-App::App() : m_MainFrameFence(VK_FENCE_CREATE_SIGNALED_BIT)
+// Matches the uniform block in Triangle.vert
+struct ObjectUniforms
 {
-	m_MainWindow = Window("Pebble", { 1600, 900 });
+	glm::mat4 Model;
+	glm::mat4 View;
+	glm::mat4 Projection;
+};
 
-	m_VertexBuffer = Buffer(sizeof(float) * 5 * 3, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-		VMA_MEMORY_USAGE_GPU_ONLY);
-	m_UniformBuffer = Buffer(sizeof(glm::mat4) * 3, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+constexpr u64 MaxObjects = 64;
+
+// Used while no window is focused or all are minimized
+constexpr f64 BackgroundFrameRate = 10.0;
+// Waiting for events still wakes up this often in seconds, so a failed render thread is noticed
+constexpr f64 IdleTimeout = 0.5;
+
+// Frames kept in the telemetry file, about ten seconds at a high frame rate
+constexpr u32 TelemetryCapacity = 4096;
+
+// Capacity of the static geometry, which holds every mesh of the position and color vertex format
+constexpr u32 MaxStaticVertices = 1 << 20;
+constexpr u32 MaxStaticIndices = 3 << 20;
+constexpr u32 MaxStaticMeshes = 4096;
+
+// Moved per frame at most while defragmenting
+constexpr u64 DefragmentationStep = 4 << 20;
+
+// Frames shown in the HUD graphs, and the time at their top in milliseconds
+constexpr u64 HudHistory = 240;
+constexpr f32 HudGraphMax = 33.3f;
+
+static void GetMemoryUsage(u64& usage, u64& budget)
+{
+	usage = 0;
+	budget = 0;
+	for (u32 heap = 0; heap < Memory::GetHeapCount(); heap++)
+	{
+		HeapUsage heapUsage = Memory::GetHeapUsage(heap);
+		usage += heapUsage.Usage;
+		budget += heapUsage.Budget;
+	}
+}
+
+App::App(u32 windowCount)
+	: m_Pool(VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT),
+	  m_FrameFence(VK_FENCE_CREATE_SIGNALED_BIT)
+{
+	ASSERT(windowCount > 0 && windowCount <= MaxWindows, "Can't open {} windows, at most {} are supported",
+		windowCount, MaxWindows);
+
+	for (u32 i = 0; i < windowCount; i++)
+	{
+		glm::u32vec2 size = i == 0 ? glm::u32vec2(1600, 900) : glm::u32vec2(800, 450);
+		std::string title = i == 0 ? "Pebble" : fmt::format("Pebble ({})", i + 1);
+		Window& window = m_Windows.Create(title.c_str(), size);
+
+		size = window.GetSwapchain().GetSize();
+		Viewport area{
+			{ 0.f, 0.f }, { float(size.x), float(size.y) }, { 0.f, 1.f }, VkRect2D{ { 0, 0 }, { size.x, size.y } }
+		};
+		m_WindowResources.push_back(WindowResources{ .Area = area });
+
+		// Everything is drawn with the same pipeline
+		ASSERT(window.GetSwapchain().GetFormat() == m_Windows.Get(0).GetSwapchain().GetFormat(),
+			"Window '{}' has a different swapchain format than the main window", title);
+	}
+	VkFormat format = m_Windows.Get(0).GetSwapchain().GetFormat();
+
+	using Vertex = std::pair<glm::vec2, glm::vec3>;
+	m_StaticGeometry = StaticGeometry(sizeof(Vertex), MaxStaticVertices, MaxStaticIndices, MaxStaticMeshes);
+
+	// Every object gets its own slice of the uniform buffer, selected with a dynamic offset
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(Instance::PhysicalDevice(), &properties);
+	u64 alignment = properties.limits.minUniformBufferOffsetAlignment;
+	m_UniformStride = (sizeof(ObjectUniforms) + alignment - 1) & ~(alignment - 1);
+	m_UniformBuffer = Buffer(m_UniformStride * MaxObjects * MaxWindows, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+		VMA_MEMORY_USAGE_CPU_TO_GPU, MemoryTag::Uniforms);
 
 	m_TriangleImage = Image(VK_IMAGE_TYPE_2D, VK_FORMAT_R8G8B8A8_SRGB, { 100, 100, 1 }, 1, 1, VK_SAMPLE_COUNT_1_BIT,
 		VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
-		VMA_MEMORY_USAGE_GPU_ONLY);
+		VMA_MEMORY_USAGE_GPU_ONLY, MemoryTag::Textures);
 
-	Buffer image(4 * 100 * 100, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+	Buffer image(4 * 100 * 100, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, MemoryTag::Staging);
 	auto imageData = reinterpret_cast<u8*>(image.Map());
 	for (u64 i = 0; i < 4 * 100 * 100; i += 4)
 	{
@@ -30,41 +100,34 @@ App::App() : m_MainFrameFence(VK_FENCE_CREATE_SIGNALED_BIT)
 	image.Unmap();
 	image.Flush(0, VK_WHOLE_SIZE);
 
-	Buffer staging(sizeof(float) * 5 * 3, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
-	auto data = reinterpret_cast<std::pair<glm::vec2, glm::vec3>*>(staging.Map());
-	data[0] = { { 0.f, -0.5f }, { 1.f, 1.f, 1.f } };
-	data[1] = { { 0.5f, 0.5f }, { 1.f, 1.f, 1.f } };
-	data[2] = { { -0.5f, 0.5f }, { 1.f, 1.f, 1.f } };
-	staging.Unmap();
-	staging.Flush(0, VK_WHOLE_SIZE);
+	Vertex triangleVertices[] = { { { 0.f, -0.5f }, { 1.f, 1.f, 1.f } }, { { 0.5f, 0.5f }, { 1.f, 1.f, 1.f } },
+		{ { -0.5f, 0.5f }, { 1.f, 1.f, 1.f } } };
+	u32 triangleIndices[] = { 0, 1, 2 };
+	m_TriangleMesh = m_StaticGeometry.Add(
+		std::span(reinterpret_cast<const u8*>(triangleVertices), sizeof(triangleVertices)), triangleIndices);
+
+	Buffer staging(m_StaticGeometry.GetUploadSize(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU,
+		MemoryTag::Staging);
 
 	auto buf = m_Pool.Allocate();
 	buf.Begin();
 
-	VkBufferCopy copy[] = { VkBufferCopy{ 0, 0, 60 } };
-	buf.CopyBuffer(staging, m_VertexBuffer, copy);
-
-	ImageBarrier barrier{ .Source = 0,
-		.Destination = VK_ACCESS_TRANSFER_WRITE_BIT,
-		.From = VK_IMAGE_LAYOUT_UNDEFINED,
-		.To = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-		.Img = m_TriangleImage,
-		.Range = VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 } };
-	buf.PipelineBarrier(
-		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, {}, {}, std::span(&barrier, 1));
-
-	VkBufferImageCopy iCopy[] = { VkBufferImageCopy{
-		0, 0, 0, VkImageSubresourceLayers{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 }, { 0, 0 }, { 100, 100, 1 } } };
-	buf.CopyBufferToImage(image, m_TriangleImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, iCopy);
-
-	ImageBarrier barrier2{ .Source = VK_ACCESS_TRANSFER_WRITE_BIT,
-		.Destination = VK_ACCESS_SHADER_READ_BIT,
-		.From = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-		.To = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-		.Img = m_TriangleImage,
-		.Range = VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 } };
-	buf.PipelineBarrier(
-		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, {}, {}, std::span(&barrier2, 1));
+	RenderGraph upload;
+	m_StaticGeometry.Upload(upload, staging);
+	GraphResource triangle = upload.ImportTrackedImage(
+		"Triangle", m_TriangleImage, nullptr, m_TriangleImage.GetFullRange(), Usage::SampledFragment);
+	upload.AddPass(
+		"Upload",
+		[&](PassBuilder& pass) {
+			pass.Write(triangle, Usage::TransferDestination);
+		},
+		[&](CommandBuffer& cmd, const RenderGraph&) {
+			VkBufferImageCopy iCopy[] = { VkBufferImageCopy{
+				0, 0, 0, VkImageSubresourceLayers{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 }, { 0, 0 }, { 100, 100, 1 } } };
+			cmd.CopyBufferToImage(image, m_TriangleImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, iCopy);
+		});
+	upload.Compile();
+	upload.Execute(buf);
 
 	buf.End();
 	CommandBuffer* bufs[] = { &buf };
@@ -79,148 +142,666 @@ App::App() : m_MainFrameFence(VK_FENCE_CREATE_SIGNALED_BIT)
 	Shader shaders[] = { Shader("../Shaders/Triangle.vert.spv", VK_SHADER_STAGE_VERTEX_BIT),
 		Shader("../Shaders/Triangle.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT) };
 
-	VkAttachmentDescription attachments[] = { VkAttachmentDescription{
-		.format = m_MainWindow.GetSwapchain().GetFormat(),
-		.samples = VK_SAMPLE_COUNT_1_BIT,
-		.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-		.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-		.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-		.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-		.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-		.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR } };
-	VkAttachmentReference refs[] = { VkAttachmentReference{
-		.attachment = 0, .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL } };
-	Subpass subpasses[] = { Subpass{ .BindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS, .Color = refs } };
-	VkSubpassDependency dependencies[] = { VkSubpassDependency{ .srcSubpass = VK_SUBPASS_EXTERNAL,
-		.dstSubpass = 0,
-		.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-		.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-		.srcAccessMask = 0,
-		.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT } };
-	m_Pass = RenderPass(attachments, subpasses, dependencies);
-
-	m_MainViewport = Viewport{ { 0.f, 0.f }, { 1600.f, 900.f }, { 0.f, 1.f }, VkRect2D{ { 0, 0 }, { 1600, 900 } } };
-
-	std::vector<DescriptorBinding> bindings = { { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT },
+	// With dynamic rendering the swapchain views are used directly, so no render pass or framebuffers are needed
+	bool dynamicRendering = Instance::Features().DynamicRendering;
+	if (!dynamicRendering)
+	{
+		VkAttachmentDescription attachments[] = { VkAttachmentDescription{
+			.format = format,
+			.samples = VK_SAMPLE_COUNT_1_BIT,
+			.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+			.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+			.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+			.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR } };
+		VkAttachmentReference refs[] = { VkAttachmentReference{
+			.attachment = 0, .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL } };
+		Subpass subpasses[] = { Subpass{ .BindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS, .Color = refs } };
+		VkSubpassDependency dependencies[] = { VkSubpassDependency{ .srcSubpass = VK_SUBPASS_EXTERNAL,
+			.dstSubpass = 0,
+			.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			.srcAccessMask = 0,
+			.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT } };
+		m_Pass = RenderPass(attachments, subpasses, dependencies);
+	}
+
+	std::vector<DescriptorBinding> bindings = {
+		{ 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_VERTEX_BIT },
 		{ 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT } };
 	m_Layout = PipelineLayout(std::span(&bindings, 1), {});
 
-	m_Pipeline = Pipeline(shaders,
-		VertexInput(
-			VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, { { VK_FORMAT_R32G32_SFLOAT, 0 }, { VK_FORMAT_R32G32B32_SFLOAT, 1 } }),
-		m_MainViewport, Rasterizer(VK_FRONT_FACE_COUNTER_CLOCKWISE), Multisample(), DepthStencil(),
-		BlendState{ { VkPipelineColorBlendAttachmentState{
-			.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT
-							  | VK_COLOR_COMPONENT_A_BIT } } },
-		DynamicState{ VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR }, m_Layout, m_Pass, 0);
+	bool extendedState = Instance::Features().ExtendedDynamicState;
+	DynamicState dynamicState = extendedState
+		? DynamicState{ VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_CULL_MODE_EXT,
+			  VK_DYNAMIC_STATE_FRONT_FACE_EXT, VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT,
+			  VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT, VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT }
+		: DynamicState{ VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+	VertexInput vertexInput(
+		VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, { { VK_FORMAT_R32G32_SFLOAT, 0 }, { VK_FORMAT_R32G32B32_SFLOAT, 1 } });
+	BlendState blendState{ { VkPipelineColorBlendAttachmentState{
+		.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT
+						  | VK_COLOR_COMPONENT_A_BIT } } };
+	if (dynamicRendering)
+	{
+		m_Pipeline = Pipeline(shaders, vertexInput, m_WindowResources[0].Area,
+			Rasterizer(VK_FRONT_FACE_COUNTER_CLOCKWISE), Multisample(), DepthStencil(), blendState, dynamicState,
+			m_Layout, RenderingFormats{ { format } });
+	}
+	else
+	{
+		m_Pipeline = Pipeline(shaders, vertexInput, m_WindowResources[0].Area,
+			Rasterizer(VK_FRONT_FACE_COUNTER_CLOCKWISE), Multisample(), DepthStencil(), blendState, dynamicState,
+			m_Layout, m_Pass, 0);
+	}
+
+	m_Hud = dynamicRendering ? Hud(m_WindowResources[0].Area, format) : Hud(m_WindowResources[0].Area, m_Pass, 0);
+	m_FrameTimeHistory.resize(HudHistory);
+	m_GpuTimeHistory.resize(HudHistory);
 
 	m_TriangleSampler = Sampler(VK_FILTER_LINEAR, VK_FILTER_LINEAR);
 
-	auto generate = [this](u32 w, u32 h) {
-		auto& views = m_MainWindow.GetSwapchain().GetViews();
-		m_MainFramebuffers.reserve(views.size());
-		m_MainFramebuffers.clear();
-		m_MainBuffers.reserve(views.size());
-		m_MainBuffers.clear();
-		m_Descriptors.reserve(views.size());
-		m_Descriptors.clear();
+	VkDescriptorPoolSize size[] = { { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 },
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 } };
+	m_DPool = DescriptorPool(size, 1);
+	m_Descriptor = m_DPool.Allocate(m_Layout, 0);
 
-		VkDescriptorPoolSize size[] = { { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, u32(views.size()) },
-			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, u32(views.size()) } };
-		m_DPool = DescriptorPool(size, u32(views.size()));
+	BufferUpdate update = { m_UniformBuffer, 0, sizeof(ObjectUniforms) };
+	m_Descriptor.Update(0, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, std::span(&update, 1));
 
-		for (const auto& view : views)
-		{
-			const ImageView* attachments[] = { &view };
-			Framebuffer& framebuffer = m_MainFramebuffers.emplace_back(m_Pass, glm::u32vec2(w, h), 1, attachments);
-			CommandBuffer& buffer = m_MainBuffers.emplace_back(m_Pool.Allocate());
-			DescriptorSet& set = m_Descriptors.emplace_back(m_DPool.Allocate(m_Layout, 0));
+	ImageUpdate iUpdate = { m_TriangleImageView, m_TriangleSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+	m_Descriptor.Update(1, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, std::span(&iUpdate, 1));
 
-			BufferUpdate update = { m_UniformBuffer, 0, sizeof(glm::mat4) * 3 };
-			set.Update(0, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, std::span(&update, 1));
+	m_FrameCommands = m_Pool.Allocate();
 
-			ImageUpdate iUpdate = { m_TriangleImageView, m_TriangleSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-			set.Update(1, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, std::span(&iUpdate, 1));
+	// Only touched by the render thread from here on, so moving the buffers can't race with recording
+	m_Defragmenter = Defragmenter(DefragmentationStep);
+	m_Defragmenter.Register(m_StaticGeometry.GetVertexBuffer());
+	m_Defragmenter.Register(m_StaticGeometry.GetIndexBuffer());
+	m_Defragmenter.Register(m_StaticGeometry.GetDrawBuffer());
+	m_Defragmenter.Register(m_UniformBuffer, [this](Buffer& buffer) {
+		BufferUpdate update = { buffer, 0, sizeof(ObjectUniforms) };
+		m_Descriptor.Update(0, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, std::span(&update, 1));
+	});
 
-			buffer.Begin();
-			VkClearValue values[] = { VkClearColorValue{ 0.f, 0.f, 0.f, 1.f } };
-			buffer.BeginRenderPass(m_Pass, framebuffer, VkRect2D{ { 0, 0 }, { w, h } }, values);
+	// Command buffers are recorded every frame, so only the framebuffers depend on the swapchains
+	auto generate = [this, dynamicRendering](u32 index, u32 w, u32 h) {
+		if (dynamicRendering)
+		{
+			return;
+		}
 
-			buffer.BindViewport(m_MainViewport);
-			buffer.BindPipeline(m_Pipeline);
-			buffer.BindVertexBuffer(m_VertexBuffer, 0);
-			buffer.BindDescriptorSet(m_Layout, 0, set);
-			buffer.Draw(3, 1, 0, 0);
+		// The frames still in flight may use the old framebuffers
+		auto& framebuffers = m_WindowResources[index].Framebuffers;
+		if (!framebuffers.empty())
+		{
+			m_RetiredFramebuffers.push_back(
+				RetiredFramebuffers{ .Frame = m_RenderFrame, .Framebuffers = std::move(framebuffers) });
+		}
 
-			buffer.EndRenderPass();
-			buffer.End();
+		auto& views = m_Windows.Get(index).GetSwapchain().GetViews();
+		framebuffers.clear();
+		framebuffers.reserve(views.size());
+		for (auto& view : views)
+		{
+			const ImageView* attachments[] = { &view };
+			framebuffers.emplace_back(m_Pass, glm::u32vec2(w, h), 1, attachments);
 		}
 	};
-	generate(m_MainWindow.GetSwapchain().GetSize().x, m_MainWindow.GetSwapchain().GetSize().y);
 
-	m_MainWindow.GetSwapchain().SetPreResizeCallback([this](u32 w, u32 h) {
-		m_MainFrameFence.WaitOn();
-		m_MainViewport = Viewport{ { 0.f, 0.f }, { float(w), float(h) }, { 0.f, 1.f }, VkRect2D{ { 0, 0 }, { w, h } } };
-	});
+	for (u32 i = 0; i < m_Windows.GetCount(); i++)
+	{
+		Window& window = m_Windows.Get(i);
+		Swapchain& swapchain = window.GetSwapchain();
+		generate(i, swapchain.GetSize().x, swapchain.GetSize().y);
+
+		// Nothing here waits on the GPU, the old swapchain and framebuffers are retired once their frames complete
+		swapchain.SetPreResizeCallback([this, i](u32 w, u32 h) {
+			m_WindowResources[i].Area =
+				Viewport{ { 0.f, 0.f }, { float(w), float(h) }, { 0.f, 1.f }, VkRect2D{ { 0, 0 }, { w, h } } };
+		});
+
+		swapchain.SetPostResizeCallback([generate, i](u32 w, u32 h) { generate(i, w, h); });
+
+		// Only hands a frame to the render thread, so presenting never happens from inside event polling. Dropped if
+		// the render thread is already behind, as there is a newer frame coming anyway.
+		window.SetRedrawCallback([this]() {
+			if (FramePacket* packet = m_Frames.TryReserve())
+			{
+				QueueFrame(*packet);
+			}
+		});
+	}
 
-	m_MainWindow.GetSwapchain().SetPostResizeCallback([this, generate](u32 w, u32 h) {
-		generate(w, h);
-		m_Draw();
-	});
+	m_Windows.Get(0).GetInput().AddKeyEvent([this](Key key, bool pressed) { HandleKey(key, pressed); });
 
-	m_Draw = [this]() {
-		std::optional<u32> imageOpt = m_MainWindow.GetSwapchain().GetNextImage(&m_MainImageAvailable, nullptr);
-		if (imageOpt)
-		{
-			m_MainFrameFence.WaitOn();
-			m_MainFrameFence.Reset();
-			u32 image = imageOpt.value();
-
-			UpdateUniformBuffer();
-			CommandBuffer* buffers[] = { &m_MainBuffers[image] };
-			std::pair<const Semaphore*, VkPipelineStageFlags> wait[] = { { &m_MainImageAvailable,
-				VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT } };
-			const Semaphore* signal[] = { &m_MainRenderFinished };
-			Instance::Submit(buffers, wait, signal, &m_MainFrameFence);
-
-			const Swapchain* swapchains[] = { &m_MainWindow.GetSwapchain() };
-			const Semaphore* swait[] = { &m_MainRenderFinished };
-			u32 indices[] = { image };
-			Swapchain::Present(swapchains, swait, indices);
-		}
-	};
-	m_MainWindow.SetRedrawCallback(m_Draw);
+	m_Pacer.SetBackgroundRate(BackgroundFrameRate);
+
+	m_Telemetry = TelemetryWriter("Telemetry.bin", TelemetryCapacity);
+	m_GpuTimer = GpuTimer(Telemetry::MaxPasses);
+	m_GpuStatistics = GpuStatistics(true);
 
 	fence.WaitOn();
+	m_LastTick = std::chrono::steady_clock::now();
 }
 
 App::~App() { Instance::WaitForIdle(); }
 
 void App::Run()
 {
-	while (!m_MainWindow.ShouldClose())
+	m_RenderThread = std::thread(&App::RenderLoop, this);
+
+	try
+	{
+		StageTimer stages;
+		bool dirty = true;
+		while (!m_Windows.ShouldClose() && !m_RenderFailed)
+		{
+			// Pacing before polling keeps the input as fresh as possible when the frame rate is capped
+			stages.Start();
+			m_Pacer.SetBackground(!m_Windows.IsFocused() || m_Windows.IsMinimized());
+			m_Pacer.Wait();
+			m_StageTimes[u32(Telemetry::Stage::Pacing)] = stages.Lap();
+
+			// Nothing would change on screen, so sleep until the window system has something for us
+			if (m_IdleRendering && !dirty && !m_Animating)
+			{
+				Window::WaitEvents(IdleTimeout);
+			}
+			else
+			{
+				Window::PollEvents();
+			}
+
+			dirty = m_Windows.UpdateInput();
+			dirty |= m_Windows.ConsumeDamage();
+			dirty |= m_RedrawRequested.exchange(false);
+			m_StageTimes[u32(Telemetry::Stage::Events)] = stages.Lap();
+
+			dirty |= Simulate();
+			m_StageTimes[u32(Telemetry::Stage::Simulate)] = stages.Lap();
+
+			// The HUD shows the frames before it, so it is never done changing
+			dirty |= m_ShowHud;
+
+			// Blocks while the render thread still reads from the other list, which paces the main thread to it
+			if (dirty || !m_IdleRendering)
+			{
+				QueueFrame(m_Frames.Reserve());
+			}
+		}
+	}
+	catch (...)
+	{
+		// A joinable thread calls std::terminate when it is destroyed, so the error would never be reported
+		StopRenderThread();
+		throw;
+	}
+	StopRenderThread();
+
+	if (m_RenderError)
+	{
+		std::rethrow_exception(m_RenderError);
+	}
+}
+
+void App::HandleKey(Key key, bool pressed)
+{
+	if (!pressed)
+	{
+		return;
+	}
+
+	constexpr f64 Caps[] = { 0.0, 30.0, 60.0, 120.0, 144.0 };
+
+	Swapchain& swapchain = m_Windows.Get(0).GetSwapchain();
+	switch (key)
 	{
-		Window::PollEvents();
+	case Key::F1: swapchain.SetPresentPolicy(PresentPolicy::LowLatency); break;
+	case Key::F2: swapchain.SetPresentPolicy(PresentPolicy::Balanced); break;
+	case Key::F3: swapchain.SetPresentPolicy(PresentPolicy::PowerSaving); break;
+	case Key::F4:
+	{
+		auto next = std::find(std::begin(Caps), std::end(Caps), m_Pacer.GetTargetRate()) + 1;
+		m_Pacer.SetTargetRate(next < std::end(Caps) ? *next : Caps[0]);
+		break;
+	}
+	case Key::F5:
+		m_IdleRendering = !m_IdleRendering;
+		INFO("Idle rendering {}", m_IdleRendering ? "enabled" : "disabled");
+		break;
+	case Key::F6: m_Animating = !m_Animating; break;
+	case Key::F7: m_ShowHud = !m_ShowHud; break;
+	default: break;
+	}
+}
 
-		m_Draw();
+bool App::Simulate()
+{
+	auto now = std::chrono::steady_clock::now();
+	f32 dt = std::chrono::duration<f32>(now - m_LastTick).count();
+	m_LastTick = now;
+
+	if (!m_Animating)
+	{
+		return false;
 	}
+
+	m_Rotation += dt * glm::radians(45.f);
+	return true;
 }
 
-void App::UpdateUniformBuffer()
+void App::BuildRenderList(RenderList& list) const
 {
-	static auto start = std::chrono::high_resolution_clock::now();
+	list.Clear();
+	list.View = glm::lookAt(glm::vec3(2.f, 2.f, 2.f), glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 0.f, 1.f));
+	list.FieldOfView = glm::radians(45.f);
+	list.Near = 0.1f;
+	list.Far = 10.f;
 
-	auto now = std::chrono::high_resolution_clock::now();
-	float dt = std::chrono::duration<float>(now - start).count();
+	list.Objects.push_back({ glm::rotate(glm::mat4(1.f), m_Rotation, glm::vec3(0.f, 0.f, 1.f)) });
+}
 
-	glm::mat4* data = reinterpret_cast<glm::mat4*>(m_UniformBuffer.Map());
+void App::QueueFrame(FramePacket& packet)
+{
+	packet.Frame = m_Frame++;
 
-	data[0] = glm::rotate(glm::mat4(1.f), dt * glm::radians(45.f), glm::vec3(0.f, 0.f, 1.f));
-	data[1] = glm::lookAt(glm::vec3(2.f, 2.f, 2.f), glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 0.f, 1.f));
-	data[2] = glm::perspective(
-		glm::radians(45.f), m_MainViewport.GetViewport().width / m_MainViewport.GetViewport().height, 0.1f, 10.f);
-	data[2][1][1] *= -1.f;
+	// Redraws from inside event polling reuse the last snapshot, whose input was already accounted for
+	const InputSnapshot& input = m_Windows.Get(0).GetInput().GetSnapshot();
+	packet.InputEvent = input.LastEvent;
+	packet.InputTime.reset();
+	if (input.OldestEvent && input.LastEvent != m_LastTaggedEvent)
+	{
+		packet.InputTime = input.OldestEvent;
+		m_LastTaggedEvent = input.LastEvent;
+	}
+
+	StageTimer build;
+	BuildRenderList(packet.List);
+	m_StageTimes[u32(Telemetry::Stage::Build)] = build.Lap();
+
+	packet.ShowHud = m_ShowHud;
+	packet.StageTimes = m_StageTimes;
+	m_StageTimes.fill(0.f);
+	m_Frames.Commit();
+}
+
+void App::StopRenderThread()
+{
+	// Reuses the slot of a packet that was reserved but never committed, its other fields are ignored
+	FramePacket& quit = m_Frames.Reserve();
+	quit.Quit = true;
+	m_Frames.Commit();
+	m_RenderThread.join();
+}
+
+void App::RenderLoop()
+{
+	try
+	{
+		StageTimer stages;
+		for (FramePacket* packet = &m_Frames.Peek(); !packet->Quit; packet = &m_Frames.Peek())
+		{
+			stages.Start();
+			auto stageTimes = packet->StageTimes;
+
+			m_RenderFrame = packet->Frame;
+			m_Windows.ApplyChanges(m_RenderFrame);
+
+			std::span<const WindowManager::AcquiredImage> images = m_Windows.Acquire();
+			stageTimes[u32(Telemetry::Stage::Acquire)] = stages.Lap();
+			if (m_Windows.IsAcquireIncomplete())
+			{
+				// The main thread may be waiting for events, and nothing else would draw the window again
+				m_RedrawRequested = true;
+				Window::PostEmptyEvent();
+			}
+			if (images.empty())
+			{
+				m_Frames.Release();
+				continue;
+			}
+
+			m_FrameFence.WaitOn();
+			m_FrameFence.Reset();
+			stageTimes[u32(Telemetry::Stage::FenceWait)] = stages.Lap();
+
+			// Everything submitted so far has completed now
+			Memory::Update(m_RenderFrame);
+			m_Defragmenter.Step();
+			WriteTelemetry();
+			m_Windows.ReleaseRetired(m_SubmittedFrames);
+			std::erase_if(m_RetiredFramebuffers,
+				[this](const RetiredFramebuffers& retired) { return retired.Frame <= m_SubmittedFrames; });
+
+			// The list isn't needed past recording, so the main thread can start building into it again
+			RecordFrame(packet->List, images, packet->ShowHud);
+			u64 frame = packet->Frame;
+			u64 inputEvent = packet->InputEvent;
+			auto inputTime = packet->InputTime;
+			u32 windowCount = u32(images.size());
+			u32 objectCount = u32(packet->List.Objects.size());
+			m_Frames.Release();
+			stageTimes[u32(Telemetry::Stage::Record)] = stages.Lap();
+
+			// All windows go out in a single submit and a single present
+			CommandBuffer* buffers[] = { &m_FrameCommands };
+			const Semaphore* signal[] = { &m_Windows.GetRenderFinished() };
+			Instance::Enqueue(buffers, m_Windows.GetWaits(), signal, &m_FrameFence);
+			Instance::Flush();
+			m_SubmittedFrames = frame + 1;
+			stageTimes[u32(Telemetry::Stage::Submit)] = stages.Lap();
+
+			if (m_Windows.Present(u32(frame)))
+			{
+				// With idle rendering the window would keep its old contents until the next input
+				m_RedrawRequested = true;
+				Window::PostEmptyEvent();
+			}
+			stageTimes[u32(Telemetry::Stage::Present)] = stages.Lap();
+
+			auto presentTime = std::chrono::steady_clock::now();
+			if (inputTime)
+			{
+				m_Latency.Presented(frame, inputEvent, inputTime.value(), presentTime);
+			}
+
+			Telemetry::FrameRecord& record = m_PendingRecord;
+			record = {};
+			record.Frame = frame;
+			record.PresentTime = u64(std::chrono::nanoseconds(presentTime.time_since_epoch()).count());
+			std::copy(stageTimes.begin(), stageTimes.end(), record.CpuTime);
+			record.Objects = objectCount;
+			CommandStats stats = Instance::TakeSubmittedStats();
+			record.Draws = stats.Draws;
+			record.Dispatches = stats.Dispatches;
+			record.PipelineBinds = stats.PipelineBinds;
+			record.DescriptorBinds = stats.DescriptorBinds;
+			record.Barriers = stats.Barriers;
+			record.Copies = stats.Copies;
+			record.Vertices = stats.Vertices;
+			record.Triangles = stats.Triangles;
+			record.InputToPresent = inputTime
+				? std::chrono::duration<f32, std::milli>(presentTime - inputTime.value()).count()
+				: -1.f;
+			record.WindowsPresented = windowCount;
+			GetMemoryUsage(record.MemoryUsage, record.MemoryBudget);
+			m_RecordPending = true;
+
+			// Display times are in the monotonic clock, which is what steady_clock uses where display timing exists
+			for (const auto& timing : m_Windows.Get(0).GetSwapchain().GetPresentTimings())
+			{
+				m_Latency.Displayed(timing.PresentId,
+					std::chrono::steady_clock::time_point(std::chrono::nanoseconds(timing.ActualTime)));
+			}
+			m_Latency.Report();
+		}
+	}
+	catch (...)
+	{
+		m_RenderError = std::current_exception();
+		m_RenderFailed = true;
+		Window::PostEmptyEvent();
+
+		// Keep draining, so the main thread can't block on a full queue before it notices
+		bool quit = false;
+		while (!quit)
+		{
+			quit = m_Frames.Peek().Quit;
+			m_Frames.Release();
+		}
+	}
+}
+
+void App::RecordFrame(const RenderList& list, std::span<const WindowManager::AcquiredImage> images, bool showHud)
+{
+	UpdateUniformBuffer(list, images);
+
+	// Only the main window gets the HUD, if it is drawn this frame at all
+	u64 hudSlot = ~0ull;
+	for (u64 slot = 0; showHud && slot < images.size(); slot++)
+	{
+		if (images[slot].WindowIndex == 0)
+		{
+			hudSlot = slot;
+		}
+	}
+	if (hudSlot != ~0ull)
+	{
+		const VkViewport& viewport = m_WindowResources[0].Area.GetViewport();
+		m_Hud.Begin(glm::vec2(viewport.width, viewport.height));
+		BuildHud(glm::vec2(viewport.width, viewport.height));
+		m_Hud.End();
+	}
+
+	bool extendedState = Instance::Features().ExtendedDynamicState;
+	auto draw = [&](CommandBuffer& cmd, u64 slot) {
+		cmd.BindViewport(m_WindowResources[images[slot].WindowIndex].Area);
+		cmd.BindPipeline(m_Pipeline);
+		if (extendedState)
+		{
+			cmd.SetCullMode(VK_CULL_MODE_BACK_BIT);
+			cmd.SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE);
+			cmd.SetDepthTest(VK_FALSE, VK_FALSE, VK_COMPARE_OP_LESS);
+		}
+		m_StaticGeometry.Bind(cmd);
+		for (u64 i = 0; i < list.Objects.size(); i++)
+		{
+			cmd.BindDescriptorSet(m_Layout, 0, m_Descriptor, u32((slot * MaxObjects + i) * m_UniformStride));
+			m_StaticGeometry.Draw(cmd, m_TriangleMesh);
+		}
+	};
+
+	auto getArea = [&](u64 slot) {
+		glm::u32vec2 size = m_Windows.Get(images[slot].WindowIndex).GetSwapchain().GetSize();
+		return VkRect2D{ { 0, 0 }, { size.x, size.y } };
+	};
+	VkClearValue values[] = { VkClearColorValue{ 0.f, 0.f, 0.f, 1.f } };
+
+	m_FrameCommands.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	m_GpuTimer.Begin(m_FrameCommands);
+	m_GpuStatistics.Begin(m_FrameCommands);
+	if (Instance::Features().DynamicRendering)
+	{
+		// One pass per window. Each waits on its acquire semaphore at color output, so that is where the transition
+		// has to happen.
+		m_FrameGraph.Reset();
+		GraphResource hudTarget = 0;
+		for (u64 slot = 0; slot < images.size(); slot++)
+		{
+			Swapchain& swapchain = m_Windows.Get(images[slot].WindowIndex).GetSwapchain();
+			u32 image = images[slot].Image;
+			GraphResource target = m_FrameGraph.ImportImage(fmt::format("Swapchain {}", images[slot].WindowIndex),
+				swapchain.GetImages()[image], &swapchain.GetViews()[image],
+				VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 },
+				ResourceAccess{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0 }, Usage::Present);
+			m_FrameGraph.AddPass(
+				fmt::format("Window {}", images[slot].WindowIndex),
+				[target](PassBuilder& pass) { pass.Write(target, Usage::ColorAttachment); },
+				[&, target, slot](CommandBuffer& cmd, const RenderGraph& graph) {
+					RenderingAttachment color[] = { { .View = graph.GetImageView(target),
+						.Layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+						.Load = VK_ATTACHMENT_LOAD_OP_CLEAR,
+						.Store = VK_ATTACHMENT_STORE_OP_STORE,
+						.Clear = values[0] } };
+					cmd.BeginRendering(getArea(slot), color);
+					draw(cmd, slot);
+					cmd.EndRendering();
+				});
+
+			if (slot == hudSlot)
+			{
+				hudTarget = target;
+			}
+		}
+
+		// Drawn over the finished main window in a pass of its own, so it shows up in the GPU times separately
+		if (hudSlot != ~0ull)
+		{
+			m_FrameGraph.AddPass(
+				"Hud",
+				[hudTarget](PassBuilder& pass) {
+					pass.Read(hudTarget, Usage::ColorAttachment);
+					pass.Write(hudTarget, Usage::ColorAttachment);
+				},
+				[&, hudTarget, hudSlot](CommandBuffer& cmd, const RenderGraph& graph) {
+					RenderingAttachment color[] = { { .View = graph.GetImageView(hudTarget),
+						.Layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+						.Load = VK_ATTACHMENT_LOAD_OP_LOAD,
+						.Store = VK_ATTACHMENT_STORE_OP_STORE } };
+					cmd.BeginRendering(getArea(hudSlot), color);
+					cmd.BindViewport(m_WindowResources[0].Area);
+					m_Hud.Draw(cmd);
+					cmd.EndRendering();
+				});
+		}
+		m_FrameGraph.Compile();
+		m_FrameGraph.Execute(m_FrameCommands, &m_GpuTimer);
+	}
+	else
+	{
+		for (u64 slot = 0; slot < images.size(); slot++)
+		{
+			auto& framebuffers = m_WindowResources[images[slot].WindowIndex].Framebuffers;
+			u32 scope = m_GpuTimer.Start(m_FrameCommands, fmt::format("Window {}", images[slot].WindowIndex));
+			m_FrameCommands.BeginRenderPass(m_Pass, framebuffers[images[slot].Image], getArea(slot), values);
+			draw(m_FrameCommands, slot);
+			// The render pass clears the window, so the HUD is drawn at the end of it instead of in a pass of its own
+			if (slot == hudSlot)
+			{
+				m_Hud.Draw(m_FrameCommands);
+			}
+			m_FrameCommands.EndRenderPass();
+			m_GpuTimer.Stop(m_FrameCommands, scope);
+		}
+	}
+	m_GpuStatistics.End(m_FrameCommands);
+	m_FrameCommands.End();
+}
+
+void App::UpdateUniformBuffer(const RenderList& list, std::span<const WindowManager::AcquiredImage> images)
+{
+	ASSERT(list.Objects.size() <= MaxObjects, "Render list has {} objects, at most {} are supported",
+		list.Objects.size(), MaxObjects);
+
+	u8* data = reinterpret_cast<u8*>(m_UniformBuffer.Map());
+	for (u64 slot = 0; slot < images.size(); slot++)
+	{
+		const VkViewport& viewport = m_WindowResources[images[slot].WindowIndex].Area.GetViewport();
+		glm::mat4 projection =
+			glm::perspective(list.FieldOfView, viewport.width / viewport.height, list.Near, list.Far);
+		projection[1][1] *= -1.f;
+
+		for (u64 i = 0; i < list.Objects.size(); i++)
+		{
+			auto uniforms = reinterpret_cast<ObjectUniforms*>(data + (slot * MaxObjects + i) * m_UniformStride);
+			uniforms->Model = list.Objects[i].Transform;
+			uniforms->View = list.View;
+			uniforms->Projection = projection;
+		}
+	}
 
 	m_UniformBuffer.Unmap();
 	m_UniformBuffer.Flush(0, VK_WHOLE_SIZE);
 }
+
+void App::WriteTelemetry()
+{
+	if (!m_RecordPending)
+	{
+		return;
+	}
+
+	// The names only live until the timer begins again, so the HUD keeps copies
+	m_HudPasses.clear();
+	f32 gpuTime = 0.f;
+	for (const GpuTime& time : m_GpuTimer.Resolve())
+	{
+		u32 index = m_Telemetry.GetPassIndex(time.Name);
+		if (index != ~0u)
+		{
+			m_PendingRecord.GpuTime[index] += f32(time.Milliseconds);
+		}
+
+		m_HudPasses.push_back(HudPass{ .Name = std::string(time.Name), .Milliseconds = f32(time.Milliseconds) });
+		gpuTime += f32(time.Milliseconds);
+	}
+
+	if (auto statistics = m_GpuStatistics.Resolve())
+	{
+		m_PendingRecord.GpuInputVertices = statistics->InputVertices;
+		m_PendingRecord.GpuInputPrimitives = statistics->InputPrimitives;
+		m_PendingRecord.GpuVertexInvocations = statistics->VertexInvocations;
+		m_PendingRecord.GpuClippingPrimitives = statistics->ClippingPrimitives;
+		m_PendingRecord.GpuFragmentInvocations = statistics->FragmentInvocations;
+		m_PendingRecord.GpuComputeInvocations = statistics->ComputeInvocations;
+	}
+
+	m_Telemetry.Write(m_PendingRecord);
+	m_RecordPending = false;
+
+	u64 head = m_HistoryHead++ % HudHistory;
+	m_FrameTimeHistory[head] = m_HudRecord.PresentTime
+		? f32(m_PendingRecord.PresentTime - m_HudRecord.PresentTime) / 1e6f
+		: 0.f;
+	m_GpuTimeHistory[head] = gpuTime;
+	m_HudRecord = m_PendingRecord;
+}
+
+void App::BuildHud(glm::vec2 size)
+{
+	constexpr f32 Scale = 2.f;
+	constexpr f32 Margin = 8.f;
+	constexpr u32 TextColor = Hud::Color(255, 255, 255);
+	constexpr u32 FrameColor = Hud::Color(80, 220, 80);
+	constexpr u32 GpuColor = Hud::Color(240, 160, 40);
+
+	const Telemetry::FrameRecord& record = m_HudRecord;
+	u64 head = m_HistoryHead % HudHistory;
+	f32 frameTime = m_FrameTimeHistory[(head + HudHistory - 1) % HudHistory];
+
+	std::string& text = m_HudText;
+	text.clear();
+	auto out = std::back_inserter(text);
+	fmt::format_to(out, "Frame {}  {:.2f} ms  {:.0f} fps\n", record.Frame, frameTime,
+		frameTime > 0.f ? 1000.f / frameTime : 0.f);
+	fmt::format_to(out, "\nCPU\n");
+	for (u32 i = 0; i < u32(Telemetry::Stage::Count); i++)
+	{
+		fmt::format_to(out, "  {:<12}{:>7.2f} ms\n", Telemetry::StageNames[i], record.CpuTime[i]);
+	}
+	fmt::format_to(out, "\nGPU\n");
+	for (const HudPass& pass : m_HudPasses)
+	{
+		fmt::format_to(out, "  {:<12}{:>7.2f} ms\n", pass.Name, pass.Milliseconds);
+	}
+	constexpr const char* Pressures[] = { "", "  high", "  critical" };
+	fmt::format_to(out, "\nMemory {} / {} MB{}\n", record.MemoryUsage >> 20, record.MemoryBudget >> 20,
+		Pressures[u32(Memory::GetPressure())]);
+	fmt::format_to(out, "Fragmentation {:.0f}% in {} blocks\n", m_Defragmenter.GetStats().Fragmentation * 100.f,
+		m_Defragmenter.GetStats().BlockCount);
+	fmt::format_to(out, "Draws {}  Dispatches {}\n", record.Draws, record.Dispatches);
+	fmt::format_to(out, "Triangles {}  Vertices {}\n", record.Triangles, record.Vertices);
+	fmt::format_to(out, "Binds {} pipeline {} descriptor\n", record.PipelineBinds, record.DescriptorBinds);
+	fmt::format_to(out, "Barriers {}  Copies {}", record.Barriers, record.Copies);
+
+	// Sized for the widest lines above, and cut off by the window if it is too small
+	f32 width = 34.f * Hud::Advance * Scale;
+	glm::vec2 graphSize(width, 80.f);
+	f32 lines = f32(std::count(text.begin(), text.end(), '\n') + 1);
+	glm::vec2 panel(width + Margin * 2.f, graphSize.y + lines * Hud::LineHeight * Scale + Margin * 3.f);
+	panel = glm::min(panel, size);
+	m_Hud.Rect(glm::vec2(0.f), panel, Hud::Color(0, 0, 0, 180));
+
+	// Frame intervals and GPU times, with a line at 60 fps
+	glm::vec2 graph(Margin);
+	m_Hud.Rect(graph, graphSize, Hud::Color(40, 40, 40, 200));
+	f32 target = graph.y + graphSize.y * (1.f - 1000.f / 60.f / HudGraphMax);
+	m_Hud.Line(glm::vec2(graph.x, target), glm::vec2(graph.x + graphSize.x, target), Hud::Color(255, 255, 255, 80));
+	m_Hud.Graph(graph, graphSize, m_FrameTimeHistory, head, HudGraphMax, FrameColor);
+	m_Hud.Graph(graph, graphSize, m_GpuTimeHistory, head, HudGraphMax, GpuColor);
+
+	m_Hud.Text(glm::vec2(Margin, graph.y + graphSize.y + Margin), text, TextColor, Scale);
+}
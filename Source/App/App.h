@@ -1,47 +1,149 @@
 #pragma once
 
-#include "Window/Window.h"
+#include "App/FramePacer.h"
+#include "App/Latency.h"
+#include "App/Telemetry.h"
+#include "Core/RingBuffer.h"
+#include "Renderer/GpuStatistics.h"
+#include "Renderer/GpuTimer.h"
+#include "Renderer/Hud.h"
+#include "Renderer/RenderGraph.h"
+#include "Renderer/RenderList.h"
+#include "Renderer/StaticGeometry.h"
+#include "Window/WindowManager.h"
 
 #include "Vulkan/Buffer.h"
 #include "Vulkan/Command.h"
+#include "Vulkan/Defragmenter.h"
 #include "Vulkan/Descriptor.h"
 #include "Vulkan/Framebuffer.h"
 #include "Vulkan/Pipeline.h"
 #include "Vulkan/Sampler.h"
 #include "Vulkan/Sync.h"
 
+// Everything the render thread needs from the main thread to produce a frame
+struct FramePacket
+{
+	u64 Frame = 0;
+	// The newest input event the frame handled, and when the oldest one it handled happened
+	u64 InputEvent = 0;
+	std::optional<std::chrono::steady_clock::time_point> InputTime;
+	// Only the main thread stages are filled in
+	std::array<f32, u32(Telemetry::Stage::Count)> StageTimes{};
+	RenderList List;
+	bool ShowHud = false;
+	bool Quit = false;
+};
+
+// The main thread polls input, simulates and builds the render list of a frame, while the render thread records and
+// submits the previous one.
 class App
 {
 public:
-	App();
+	// Each window has its own projection, so it gets its own set of object slices
+	static constexpr u32 MaxWindows = 4;
+
+	// Every window shows the same scene, the first one is the main window
+	App(u32 windowCount = 1);
 	~App();
 
 	void Run();
 
 private:
-	void UpdateUniformBuffer();
+	void HandleKey(Key key, bool pressed);
+	// Returns whether anything changed
+	bool Simulate();
+	void BuildRenderList(RenderList& list) const;
+	void QueueFrame(FramePacket& packet);
+	// Blocks until the render thread has finished the queued frames
+	void StopRenderThread();
+
+	void RenderLoop();
+	void RecordFrame(const RenderList& list, std::span<const WindowManager::AcquiredImage> images, bool showHud);
+	void UpdateUniformBuffer(const RenderList& list, std::span<const WindowManager::AcquiredImage> images);
+	void WriteTelemetry();
+	// Shows the last completed frame on the main window
+	void BuildHud(glm::vec2 size);
+
+	struct WindowResources
+	{
+		Viewport Area;
+		std::vector<Framebuffer> Framebuffers;
+	};
 
-	Window m_MainWindow;
-	std::vector<Framebuffer> m_MainFramebuffers;
+	struct RetiredFramebuffers
+	{
+		u64 Frame;
+		std::vector<Framebuffer> Framebuffers;
+	};
 
-	Buffer m_VertexBuffer;
+	WindowManager m_Windows;
+	// Indexed like the windows, only touched by the render thread after construction
+	std::vector<WindowResources> m_WindowResources;
+	std::vector<RetiredFramebuffers> m_RetiredFramebuffers;
+
+	StaticGeometry m_StaticGeometry;
+	u32 m_TriangleMesh = 0;
 	Buffer m_UniformBuffer;
+	u64 m_UniformStride = 0;
 	Image m_TriangleImage;
 	ImageView m_TriangleImageView;
 	Sampler m_TriangleSampler;
 	Pipeline m_Pipeline;
 	PipelineLayout m_Layout;
 	RenderPass m_Pass;
-	Viewport m_MainViewport;
 
 	CommandPool m_Pool;
-	std::vector<CommandBuffer> m_MainBuffers;
+	CommandBuffer m_FrameCommands;
+	RenderGraph m_FrameGraph;
 
 	DescriptorPool m_DPool;
-	std::vector<DescriptorSet> m_Descriptors;
+	DescriptorSet m_Descriptor;
+
+	Fence m_FrameFence;
+	Defragmenter m_Defragmenter;
+
+	// Double buffered, so the next frame is built while the render thread records from the other list without locking
+	RingBuffer<FramePacket, 2> m_Frames;
+	std::thread m_RenderThread;
+	std::atomic<bool> m_RenderFailed = false;
+	std::exception_ptr m_RenderError;
+	// Set by the render thread when a window couldn't be drawn and needs another frame
+	std::atomic<bool> m_RedrawRequested = false;
+	LatencyTracker m_Latency;
+	TelemetryWriter m_Telemetry;
+	GpuTimer m_GpuTimer;
+	GpuStatistics m_GpuStatistics;
+	// Completed once the GPU times of the frame are in, which is when the next frame waits on the fence
+	Telemetry::FrameRecord m_PendingRecord{};
+	bool m_RecordPending = false;
+
+	struct HudPass
+	{
+		std::string Name;
+		f32 Milliseconds;
+	};
+
+	Hud m_Hud;
+	Telemetry::FrameRecord m_HudRecord{};
+	std::vector<HudPass> m_HudPasses;
+	// Kept to not allocate the text every frame
+	std::string m_HudText;
+	// Rings of frame intervals and GPU times, the oldest at the head
+	std::vector<f32> m_FrameTimeHistory;
+	std::vector<f32> m_GpuTimeHistory;
+	u64 m_HistoryHead = 0;
+	u64 m_RenderFrame = 0;
+	u64 m_SubmittedFrames = 0;
 
-	Semaphore m_MainImageAvailable;
-	Semaphore m_MainRenderFinished;
-	Fence m_MainFrameFence;
-	std::function<void()> m_Draw;
+	FramePacer m_Pacer;
+	// Only draws when input, a resize or an animation changed something
+	bool m_IdleRendering = true;
+	bool m_Animating = true;
+	bool m_ShowHud = false;
+	u64 m_Frame = 0;
+	u64 m_LastTaggedEvent = 0;
+	std::array<f32, u32(Telemetry::Stage::Count)> m_StageTimes{};
+	f32 m_Rotation = 0.f;
+	std::chrono::steady_clock::time_point m_LastTick;
 };
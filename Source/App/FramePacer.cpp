@@ -0,0 +1,96 @@
+#include "PCH.h"
+
+#include "FramePacer.h"
+
+void FramePacer::SetTargetRate(f64 framesPerSecond)
+{
+	m_Rate = std::max(framesPerSecond, 0.0);
+	UpdateInterval();
+
+	if (m_Rate > 0.0)
+	{
+		INFO("Capping the frame rate to {} fps", m_Rate);
+	}
+	else
+	{
+		INFO("Frame rate cap disabled");
+	}
+}
+
+void FramePacer::SetBackgroundRate(f64 framesPerSecond)
+{
+	m_BackgroundRate = std::max(framesPerSecond, 0.0);
+	UpdateInterval();
+
+	if (m_BackgroundRate > 0.0)
+	{
+		INFO("Capping the frame rate to {} fps in the background", m_BackgroundRate);
+	}
+	else
+	{
+		INFO("Background frame rate cap disabled");
+	}
+}
+
+void FramePacer::SetBackground(bool background)
+{
+	if (m_Background != background)
+	{
+		m_Background = background;
+		UpdateInterval();
+	}
+}
+
+void FramePacer::UpdateInterval()
+{
+	f64 rate = m_Rate;
+	if (m_Background && m_BackgroundRate > 0.0 && (rate == 0.0 || m_BackgroundRate < rate))
+	{
+		rate = m_BackgroundRate;
+	}
+
+	m_Interval = rate > 0.0
+		? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<f64>(1.0 / rate))
+		: Clock::duration::zero();
+	m_Next = Clock::now();
+}
+
+void FramePacer::Wait()
+{
+	if (m_Interval == Clock::duration::zero())
+	{
+		return;
+	}
+
+	auto now = Clock::now();
+	if (now >= m_Next)
+	{
+		// Too far behind to catch up without a burst of frames, so start the schedule over
+		m_Next = now - m_Next > m_Interval ? now + m_Interval : m_Next + m_Interval;
+		return;
+	}
+
+	if (m_Next - now > m_SpinMargin)
+	{
+		auto target = m_Next - m_SpinMargin;
+		std::this_thread::sleep_until(target);
+
+		// Grows right away on an overshoot, and shrinks slowly so a single good sleep doesn't cause a miss
+		auto overshoot = Clock::now() - target;
+		if (overshoot > m_SpinMargin)
+		{
+			m_SpinMargin = std::min(overshoot, m_Interval / 2);
+		}
+		else
+		{
+			m_SpinMargin -= (m_SpinMargin - overshoot) / 16;
+		}
+	}
+
+	while (Clock::now() < m_Next)
+	{
+		std::this_thread::yield();
+	}
+
+	m_Next += m_Interval;
+}
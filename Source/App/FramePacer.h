@@ -0,0 +1,31 @@
+#pragma once
+
+// Caps the frame rate by sleeping most of the way to the next frame and spinning for the rest, as sleeps overshoot
+// by up to a scheduler tick. The spin margin adapts to how much sleeps have been overshooting.
+class FramePacer
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// Zero disables the cap
+	void SetTargetRate(f64 framesPerSecond);
+	f64 GetTargetRate() const { return m_Rate; }
+
+	// Used instead of the target rate while in the background, if it is lower. Zero disables it.
+	void SetBackgroundRate(f64 framesPerSecond);
+	f64 GetBackgroundRate() const { return m_BackgroundRate; }
+	void SetBackground(bool background);
+
+	// Returns once the next frame is due
+	void Wait();
+
+private:
+	void UpdateInterval();
+
+	f64 m_Rate = 0.0;
+	f64 m_BackgroundRate = 0.0;
+	bool m_Background = false;
+	Clock::duration m_Interval = Clock::duration::zero();
+	Clock::time_point m_Next;
+	Clock::duration m_SpinMargin = std::chrono::milliseconds(2);
+};
@@ -0,0 +1,53 @@
+#include "PCH.h"
+
+#include "Latency.h"
+
+static u64 ToMicroseconds(LatencyTracker::Clock::duration duration)
+{
+	return u64(std::max(std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), i64(0)));
+}
+
+void LatencyTracker::Presented(u64 frame, u64 inputEvent, Clock::time_point input, Clock::time_point present)
+{
+	m_ToPresent.Add(ToMicroseconds(present - input));
+	m_Pending[frame % m_Pending.size()] = PendingFrame{ .Frame = frame, .InputEvent = inputEvent, .Input = input };
+}
+
+void LatencyTracker::Displayed(u32 presentId, Clock::time_point display)
+{
+	PendingFrame& pending = m_Pending[presentId % m_Pending.size()];
+	if (pending.Frame == ~0ull || u32(pending.Frame) != presentId)
+	{
+		return;
+	}
+
+	m_ToDisplay.Add(ToMicroseconds(display - pending.Input));
+	TRACE("Input {} displayed {} us after it happened", pending.InputEvent, ToMicroseconds(display - pending.Input));
+	pending.Frame = ~0ull;
+}
+
+void LatencyTracker::Report(Clock::duration interval)
+{
+	auto now = Clock::now();
+	if (now - m_LastReport < interval)
+	{
+		return;
+	}
+	m_LastReport = now;
+
+	if (m_ToPresent.GetCount() != 0)
+	{
+		INFO("Input to present: p50 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms over {} frames",
+			m_ToPresent.GetPercentile(0.5) / 1000.0, m_ToPresent.GetPercentile(0.99) / 1000.0,
+			m_ToPresent.GetMax() / 1000.0, m_ToPresent.GetCount());
+	}
+	if (m_ToDisplay.GetCount() != 0)
+	{
+		INFO("Input to display: p50 {:.2f} ms, p99 {:.2f} ms, max {:.2f} ms over {} frames",
+			m_ToDisplay.GetPercentile(0.5) / 1000.0, m_ToDisplay.GetPercentile(0.99) / 1000.0,
+			m_ToDisplay.GetMax() / 1000.0, m_ToDisplay.GetCount());
+	}
+
+	m_ToPresent.Reset();
+	m_ToDisplay.Reset();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Core/Histogram.h"
+
+// Measures from the oldest input a frame handled to when the frame was presented, and to when it actually showed up
+// on the display where the driver reports that. Only used from the render thread.
+class LatencyTracker
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	void Presented(u64 frame, u64 inputEvent, Clock::time_point input, Clock::time_point present);
+	// Frames are matched by the low 32 bits, which is what the present ID holds
+	void Displayed(u32 presentId, Clock::time_point display);
+
+	// Logs the percentiles gathered since the last report, at most once per interval
+	void Report(Clock::duration interval = std::chrono::seconds(5));
+
+private:
+	struct PendingFrame
+	{
+		u64 Frame = ~0ull;
+		u64 InputEvent;
+		Clock::time_point Input;
+	};
+
+	// Display times come back a few frames late, anything older than this is dropped
+	std::array<PendingFrame, 16> m_Pending;
+
+	Histogram m_ToPresent;
+	Histogram m_ToDisplay;
+	Clock::time_point m_LastReport = Clock::now();
+};
@@ -2,33 +2,45 @@
 
 #include "Logger.h"
 
+#include "spdlog/async.h"
 #include "spdlog/sinks/basic_file_sink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 
-std::shared_ptr<spdlog::logger> Logger::s_Logger;
-std::once_flag Logger::s_Init;
+// Messages the queue holds before the oldest ones get dropped
+constexpr u64 QueueSize = 8192;
 
-const std::shared_ptr<spdlog::logger>& Logger::Get()
+spdlog::logger* Logger::s_Logger = nullptr;
+
+void Logger::Init()
 {
-	std::call_once(s_Init, []() {
-		auto console = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+	auto console = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
 #ifdef NDEBUG
-		console->set_level(spdlog::level::info);
+	console->set_level(spdlog::level::info);
 #else
-		console->set_level(spdlog::level::debug);
+	console->set_level(spdlog::level::debug);
 #endif
-		console->set_pattern("[%I:%M:%S.%e] %^%l%$: %v");
-
-		auto file = std::make_shared<spdlog::sinks::basic_file_sink_mt>("Log.txt", true);
-		file->set_level(spdlog::level::trace);
-		file->set_pattern("[%I:%M:%S.%e] %^%l%$: %v");
-
-		s_Logger = std::make_shared<spdlog::logger>(
-			"Main", std::initializer_list<std::shared_ptr<spdlog::sinks::sink>>{ console, file });
-		s_Logger->set_level(spdlog::level::trace);
-
-		spdlog::flush_every(std::chrono::seconds(5));
-	});
+	console->set_pattern("[%I:%M:%S.%e] %^%l%$: %v");
+
+	auto file = std::make_shared<spdlog::sinks::basic_file_sink_mt>("Log.txt", true);
+	file->set_level(spdlog::level::trace);
+	file->set_pattern("[%I:%M:%S.%e] %^%l%$: %v");
+
+	// The queue is allocated up front, and a single writer keeps the messages in order
+	spdlog::init_thread_pool(QueueSize, 1);
+	auto logger = std::make_shared<spdlog::async_logger>("Main",
+		std::initializer_list<std::shared_ptr<spdlog::sinks::sink>>{ console, file }, spdlog::thread_pool(),
+		spdlog::async_overflow_policy::overrun_oldest);
+	logger->set_level(spdlog::level::trace);
+	logger->flush_on(spdlog::level::err);
+
+	// The registry keeps the logger alive, which the async logger needs as messages hold a reference to it
+	spdlog::register_logger(logger);
+	spdlog::flush_every(std::chrono::seconds(5));
+	s_Logger = logger.get();
+}
 
-	return s_Logger;
+void Logger::Cleanup()
+{
+	s_Logger = nullptr;
+	spdlog::shutdown();
 }
@@ -2,27 +2,74 @@
 
 #include "spdlog/spdlog.h"
 
+// Messages below this level are compiled out, arguments included. Uses spdlog's levels, from 0 for trace to 5 for
+// critical. Set through the PEBBLE_LOG_LEVEL CMake option.
+#ifndef PEBBLE_LOG_LEVEL
+#ifdef NDEBUG
+#define PEBBLE_LOG_LEVEL 2
+#else
+#define PEBBLE_LOG_LEVEL 0
+#endif
+#endif
+
+// Messages are formatted on the calling thread and written out by a background thread. When the queue is full the
+// oldest messages are dropped, so logging never blocks.
 class Logger
 {
 public:
 	Logger() = delete;
 
-	static const std::shared_ptr<spdlog::logger>& Get();
+	// Nothing may log before Init or after Cleanup, which writes out everything still queued
+	static void Init();
+	static void Cleanup();
+
+	static spdlog::logger* Get() { return s_Logger; }
 
 private:
-	static std::shared_ptr<spdlog::logger> s_Logger;
-	static std::once_flag s_Init;
+	static spdlog::logger* s_Logger;
 };
 
+#if PEBBLE_LOG_LEVEL <= 0
 #define TRACE(...) Logger::Get()->trace(__VA_ARGS__)
+#else
+#define TRACE(...) (void)0
+#endif
+
+#if PEBBLE_LOG_LEVEL <= 1
 #define DEBUG(...) Logger::Get()->debug(__VA_ARGS__)
+#else
+#define DEBUG(...) (void)0
+#endif
+
+#if PEBBLE_LOG_LEVEL <= 2
 #define INFO(...) Logger::Get()->info(__VA_ARGS__)
+#else
+#define INFO(...) (void)0
+#endif
+
+#if PEBBLE_LOG_LEVEL <= 3
 #define WARN(...) Logger::Get()->warn(__VA_ARGS__)
+#else
+#define WARN(...) (void)0
+#endif
+
+#if PEBBLE_LOG_LEVEL <= 4
 #define ERROR(...) Logger::Get()->error(__VA_ARGS__)
+#else
+#define ERROR(...) (void)0
+#endif
+
+#if PEBBLE_LOG_LEVEL <= 5
+#define LOG_CRITICAL(...) Logger::Get()->critical(__VA_ARGS__)
+#else
+#define LOG_CRITICAL(...) (void)0
+#endif
+
+// Throws even when the message is compiled out
 #define CRITICAL(...)                                                                                                  \
 	do                                                                                                                 \
 	{                                                                                                                  \
-		Logger::Get()->critical(__VA_ARGS__);                                                                          \
+		LOG_CRITICAL(__VA_ARGS__);                                                                                     \
 		throw 1;                                                                                                       \
 	} while (false)
 
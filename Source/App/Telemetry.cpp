@@ -0,0 +1,177 @@
+#include "PCH.h"
+
+#include "Telemetry.h"
+
+#ifdef _WIN32
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	define NOGDI
+#	include <Windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <unistd.h>
+#endif
+
+TelemetryWriter::TelemetryWriter(const std::filesystem::path& path, u32 capacity)
+{
+	m_Size = sizeof(Telemetry::FileHeader) + u64(capacity) * sizeof(Telemetry::FrameRecord);
+
+#ifdef _WIN32
+	m_File = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+		CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_File == INVALID_HANDLE_VALUE)
+	{
+		m_File = nullptr;
+		WARN("Failed to create telemetry file '{}'", path.string());
+		return;
+	}
+
+	m_Mapping = CreateFileMappingW(m_File, nullptr, PAGE_READWRITE, DWORD(m_Size >> 32), DWORD(m_Size), nullptr);
+	void* data = m_Mapping ? MapViewOfFile(m_Mapping, FILE_MAP_ALL_ACCESS, 0, 0, m_Size) : nullptr;
+#else
+	m_File = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (m_File < 0)
+	{
+		WARN("Failed to create telemetry file '{}'", path.string());
+		return;
+	}
+
+	void* data = nullptr;
+	if (ftruncate(m_File, off_t(m_Size)) == 0)
+	{
+		data = mmap(nullptr, m_Size, PROT_READ | PROT_WRITE, MAP_SHARED, m_File, 0);
+		data = data == MAP_FAILED ? nullptr : data;
+	}
+#endif
+
+	if (!data)
+	{
+		WARN("Failed to map telemetry file '{}'", path.string());
+		Close();
+		return;
+	}
+
+	// The file is new and zeroed, so only the fields that aren't zero are set
+	m_Header = static_cast<Telemetry::FileHeader*>(data);
+	m_Records = reinterpret_cast<Telemetry::FrameRecord*>(m_Header + 1);
+	m_Header->Magic = Telemetry::Magic;
+	m_Header->Version = Telemetry::Version;
+	m_Header->HeaderSize = sizeof(Telemetry::FileHeader);
+	m_Header->RecordSize = sizeof(Telemetry::FrameRecord);
+	m_Header->Capacity = capacity;
+
+	INFO("Writing telemetry to '{}'", path.string());
+}
+
+TelemetryWriter::~TelemetryWriter() { Close(); }
+
+TelemetryWriter::TelemetryWriter(TelemetryWriter&& other)
+{
+	m_Header = other.m_Header;
+	other.m_Header = nullptr;
+	m_Records = other.m_Records;
+	other.m_Records = nullptr;
+	m_Size = other.m_Size;
+	m_File = other.m_File;
+#ifdef _WIN32
+	other.m_File = nullptr;
+	m_Mapping = other.m_Mapping;
+	other.m_Mapping = nullptr;
+#else
+	other.m_File = -1;
+#endif
+}
+
+TelemetryWriter& TelemetryWriter::operator=(TelemetryWriter&& other)
+{
+	Close();
+
+	m_Header = other.m_Header;
+	other.m_Header = nullptr;
+	m_Records = other.m_Records;
+	other.m_Records = nullptr;
+	m_Size = other.m_Size;
+	m_File = other.m_File;
+#ifdef _WIN32
+	other.m_File = nullptr;
+	m_Mapping = other.m_Mapping;
+	other.m_Mapping = nullptr;
+#else
+	other.m_File = -1;
+#endif
+
+	return *this;
+}
+
+u32 TelemetryWriter::GetPassIndex(std::string_view name)
+{
+	if (!m_Header)
+	{
+		return ~0u;
+	}
+
+	name = name.substr(0, Telemetry::MaxPassName - 1);
+	u32 count = m_Header->PassCount;
+	for (u32 i = 0; i < count; i++)
+	{
+		if (name == m_Header->PassNames[i])
+		{
+			return i;
+		}
+	}
+
+	if (count == Telemetry::MaxPasses)
+	{
+		return ~0u;
+	}
+
+	std::memcpy(m_Header->PassNames[count], name.data(), name.size());
+	std::atomic_ref(m_Header->PassCount).store(count + 1, std::memory_order_release);
+	return count;
+}
+
+void TelemetryWriter::Write(const Telemetry::FrameRecord& record)
+{
+	if (!m_Header)
+	{
+		return;
+	}
+
+	u64 index = m_Header->WriteCount;
+	m_Records[index % m_Header->Capacity] = record;
+	std::atomic_ref(m_Header->WriteCount).store(index + 1, std::memory_order_release);
+}
+
+void TelemetryWriter::Close()
+{
+#ifdef _WIN32
+	if (m_Header)
+	{
+		UnmapViewOfFile(m_Header);
+	}
+	if (m_Mapping)
+	{
+		CloseHandle(m_Mapping);
+	}
+	if (m_File)
+	{
+		CloseHandle(m_File);
+	}
+	m_Mapping = nullptr;
+	m_File = nullptr;
+#else
+	if (m_Header)
+	{
+		munmap(m_Header, m_Size);
+	}
+	if (m_File >= 0)
+	{
+		close(m_File);
+	}
+	m_File = -1;
+#endif
+
+	m_Header = nullptr;
+	m_Records = nullptr;
+}
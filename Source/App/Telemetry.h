@@ -0,0 +1,61 @@
+#pragma once
+
+#include "TelemetryFormat.h"
+
+// Times consecutive stages of a frame
+class StageTimer
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	void Start() { m_Last = Clock::now(); }
+
+	// Milliseconds since the last lap, or since the start
+	f32 Lap()
+	{
+		auto now = Clock::now();
+		f32 time = std::chrono::duration<f32, std::milli>(now - m_Last).count();
+		m_Last = now;
+		return time;
+	}
+
+private:
+	Clock::time_point m_Last = Clock::now();
+};
+
+// Writes a record per frame into a memory mapped ring file, which other processes can tail while the app runs. Only
+// used from the render thread.
+class TelemetryWriter
+{
+public:
+	TelemetryWriter() = default;
+	// Telemetry is optional, so failing to open the file only warns and leaves the writer closed
+	TelemetryWriter(const std::filesystem::path& path, u32 capacity);
+	~TelemetryWriter();
+
+	TelemetryWriter(const TelemetryWriter& other) = delete;
+	TelemetryWriter& operator=(const TelemetryWriter& other) = delete;
+
+	TelemetryWriter(TelemetryWriter&& other);
+	TelemetryWriter& operator=(TelemetryWriter&& other);
+
+	bool IsOpen() const { return m_Header; }
+
+	// Index of the pass in the GPU times of a record, ~0u once all of them are taken
+	u32 GetPassIndex(std::string_view name);
+	void Write(const Telemetry::FrameRecord& record);
+
+private:
+	void Close();
+
+	Telemetry::FileHeader* m_Header = nullptr;
+	Telemetry::FrameRecord* m_Records = nullptr;
+	u64 m_Size = 0;
+
+#ifdef _WIN32
+	void* m_File = nullptr;
+	void* m_Mapping = nullptr;
+#else
+	int m_File = -1;
+#endif
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+// Layout of the telemetry ring file, shared with Tools/TelemetryToCsv. Everything is plain data with fixed sizes and no
+// padding, so readers can copy records straight out of the file. The version has to change with the layout.
+namespace Telemetry {
+
+constexpr u32 Magic = 0x4C544250; // "PBTL"
+constexpr u32 Version = 2;
+
+enum class Stage : u32
+{
+	// Main thread
+	Pacing, Events, Simulate, Build,
+	// Render thread
+	Acquire, FenceWait, Record, Submit, Present,
+	Count
+};
+
+constexpr const char* StageNames[] = { "pacing", "events", "simulate", "build", "acquire", "fence_wait", "record",
+	"submit", "present" };
+static_assert(std::size(StageNames) == u32(Stage::Count));
+
+constexpr u32 MaxPasses = 16;
+constexpr u32 MaxPassName = 32;
+
+struct FileHeader
+{
+	u32 Magic;
+	u32 Version;
+	u32 HeaderSize;
+	u32 RecordSize;
+	u32 Capacity;
+	// Names are only ever added, and each is written before the count includes it
+	u32 PassCount;
+	// Records written so far, record i is at i % Capacity. Increased once a record is complete, so a reader that copied
+	// record i is fine as long as this is still below i + Capacity afterwards.
+	u64 WriteCount;
+	char PassNames[MaxPasses][MaxPassName];
+};
+
+// Times are in milliseconds, and zero for anything that wasn't measured
+struct FrameRecord
+{
+	u64 Frame;
+	// Nanoseconds of the steady clock
+	u64 PresentTime;
+	f32 CpuTime[u32(Stage::Count)];
+	// Indexed like the pass names in the header
+	f32 GpuTime[MaxPasses];
+	u32 Objects;
+	// Counted while recording, over everything submitted in the frame
+	u32 Draws;
+	u32 Dispatches;
+	u32 PipelineBinds;
+	u32 DescriptorBinds;
+	u32 Barriers;
+	u32 Copies;
+	// From the oldest input the frame handled, negative if it didn't handle any
+	f32 InputToPresent;
+	u32 WindowsPresented;
+	u64 Vertices;
+	u64 Triangles;
+	// Bytes, summed over all heaps
+	u64 MemoryUsage;
+	u64 MemoryBudget;
+	// From pipeline statistics queries, zero where they aren't supported
+	u64 GpuInputVertices;
+	u64 GpuInputPrimitives;
+	u64 GpuVertexInvocations;
+	u64 GpuClippingPrimitives;
+	u64 GpuFragmentInvocations;
+	u64 GpuComputeInvocations;
+};
+
+static_assert(sizeof(FileHeader) == 32 + MaxPasses * MaxPassName);
+static_assert(sizeof(FrameRecord) == 232);
+static_assert(std::is_trivially_copyable_v<FileHeader> && std::is_trivially_copyable_v<FrameRecord>);
+
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+// Log-linear buckets, 32 per power of two, so percentiles stay within ~3% of the real value over the whole u64 range
+// without keeping the samples around
+class Histogram
+{
+public:
+	void Add(u64 value)
+	{
+		m_Buckets[GetIndex(value)]++;
+		m_Count++;
+		m_Max = std::max(m_Max, value);
+	}
+
+	void Reset()
+	{
+		m_Buckets.fill(0);
+		m_Count = 0;
+		m_Max = 0;
+	}
+
+	u64 GetCount() const { return m_Count; }
+	u64 GetMax() const { return m_Max; }
+
+	// Percentile in [0, 1], returns the middle of the bucket the percentile falls into
+	u64 GetPercentile(f64 percentile) const
+	{
+		if (m_Count == 0)
+		{
+			return 0;
+		}
+
+		u64 target = std::max(u64(std::ceil(percentile * f64(m_Count))), u64(1));
+		u64 seen = 0;
+		for (u32 i = 0; i < BucketCount; i++)
+		{
+			seen += m_Buckets[i];
+			if (seen >= target)
+			{
+				u64 lower = GetLowerBound(i);
+				u64 upper = i + 1 < BucketCount ? GetLowerBound(i + 1) : m_Max + 1;
+				return std::min(lower + (upper - lower) / 2, m_Max);
+			}
+		}
+
+		return m_Max;
+	}
+
+private:
+	static constexpr u32 SubBits = 5;
+	static constexpr u32 SubCount = 1 << SubBits;
+	static constexpr u32 BucketCount = (64 - SubBits + 1) * SubCount;
+
+	static u32 GetIndex(u64 value)
+	{
+		if (value < SubCount)
+		{
+			return u32(value);
+		}
+
+		u32 exponent = u32(std::bit_width(value)) - 1;
+		u32 shift = exponent - SubBits;
+		return (shift + 1) * SubCount + u32((value >> shift) - SubCount);
+	}
+
+	static u64 GetLowerBound(u32 index)
+	{
+		if (index < SubCount)
+		{
+			return index;
+		}
+
+		u32 shift = index / SubCount - 1;
+		return u64(SubCount + index % SubCount) << shift;
+	}
+
+	std::array<u32, BucketCount> m_Buckets{};
+	u64 m_Count = 0;
+	u64 m_Max = 0;
+};
@@ -0,0 +1,527 @@
+#include "PCH.h"
+
+#include "JobSystem.h"
+
+namespace Jobs {
+
+struct Task
+{
+	std::function<void()> Function;
+	Task* Parent = nullptr;
+
+	// The task itself and every child that hasn't finished yet
+	std::atomic<u32> Unfinished = 1;
+	// Unfinished dependencies, plus one until the task is submitted
+	std::atomic<u32> Blockers = 1;
+	std::atomic<u32> References = 1;
+
+	// Guards Finished and Successors, which are only touched when setting up dependencies and when finishing
+	std::atomic_flag Lock;
+	bool Finished = false;
+	std::vector<Task*> Successors;
+};
+
+// Chase-Lev deque. The owning worker pushes and pops at the bottom, everyone else steals from the top.
+class WorkQueue
+{
+public:
+	bool Push(Task* task)
+	{
+		i64 bottom = m_Bottom.load(std::memory_order_relaxed);
+		i64 top = m_Top.load(std::memory_order_acquire);
+		if (bottom - top >= i64(Capacity))
+		{
+			return false;
+		}
+
+		m_Tasks[bottom & (Capacity - 1)].store(task, std::memory_order_relaxed);
+		m_Bottom.store(bottom + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	// The claim on the bottom has to be ordered before reading the top, and stealing the other way round, so both
+	// use sequentially consistent operations
+	Task* Pop()
+	{
+		i64 bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+		m_Bottom.store(bottom, std::memory_order_seq_cst);
+		i64 top = m_Top.load(std::memory_order_seq_cst);
+
+		if (top > bottom)
+		{
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Task* task = m_Tasks[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+		if (top == bottom)
+		{
+			// Last task, so a thief might be going for it as well
+			if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				task = nullptr;
+			}
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+
+		return task;
+	}
+
+	Task* Steal()
+	{
+		i64 top = m_Top.load(std::memory_order_seq_cst);
+		i64 bottom = m_Bottom.load(std::memory_order_seq_cst);
+
+		if (top >= bottom)
+		{
+			return nullptr;
+		}
+
+		Task* task = m_Tasks[top & (Capacity - 1)].load(std::memory_order_relaxed);
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return nullptr;
+		}
+
+		return task;
+	}
+
+private:
+	static constexpr u64 Capacity = 4096;
+
+	alignas(64) std::atomic<i64> m_Top = 0;
+	alignas(64) std::atomic<i64> m_Bottom = 0;
+	std::array<std::atomic<Task*>, Capacity> m_Tasks;
+};
+
+// Tasks are recycled per thread, so spawning doesn't go through the allocator once the caches are warm
+struct TaskCache
+{
+	~TaskCache()
+	{
+		for (Task* task : Free)
+		{
+			delete task;
+		}
+	}
+
+	std::vector<Task*> Free;
+};
+
+constexpr u64 MaxCachedTasks = 1024;
+
+std::vector<std::unique_ptr<WorkQueue>> s_Queues;
+std::vector<std::thread> s_Threads;
+std::atomic<bool> s_Running = false;
+
+// Tasks scheduled by threads that aren't workers
+std::mutex s_InjectedMutex;
+std::vector<Task*> s_Injected;
+std::atomic<u64> s_InjectedCount = 0;
+
+// Idle workers sleep on the epoch, which is bumped whenever a task is scheduled
+std::atomic<u64> s_Epoch = 0;
+std::atomic<u32> s_Sleeping = 0;
+
+thread_local u32 t_Worker = ~0u;
+thread_local u32 t_Random = 0x9E3779B9u;
+thread_local TaskCache t_Cache;
+
+static void Execute(Task* task);
+
+static void LockTask(Task* task)
+{
+	while (task->Lock.test_and_set(std::memory_order_acquire))
+	{
+		std::this_thread::yield();
+	}
+}
+
+static void UnlockTask(Task* task) { task->Lock.clear(std::memory_order_release); }
+
+static Task* AllocateTask()
+{
+	if (t_Cache.Free.empty())
+	{
+		return new Task;
+	}
+
+	Task* task = t_Cache.Free.back();
+	t_Cache.Free.pop_back();
+
+	task->Unfinished.store(1, std::memory_order_relaxed);
+	task->Blockers.store(1, std::memory_order_relaxed);
+	task->References.store(1, std::memory_order_relaxed);
+	task->Finished = false;
+
+	return task;
+}
+
+static void Release(Task* task)
+{
+	if (task->References.fetch_sub(1, std::memory_order_acq_rel) != 1)
+	{
+		return;
+	}
+
+	if (t_Cache.Free.size() >= MaxCachedTasks)
+	{
+		delete task;
+		return;
+	}
+
+	// Keeps the successor allocation around, but the captures of the function have to go now
+	task->Function = nullptr;
+	task->Parent = nullptr;
+	task->Successors.clear();
+	t_Cache.Free.push_back(task);
+}
+
+static void Wake()
+{
+	s_Epoch.fetch_add(1, std::memory_order_seq_cst);
+	if (s_Sleeping.load(std::memory_order_seq_cst) > 0)
+	{
+		s_Epoch.notify_one();
+	}
+}
+
+static void Schedule(Task* task)
+{
+	if (t_Worker != ~0u)
+	{
+		if (!s_Queues[t_Worker]->Push(task))
+		{
+			// Running it right away keeps the queue bounded, and is what the worker would end up doing anyway
+			Execute(task);
+			return;
+		}
+	}
+	else
+	{
+		std::scoped_lock lock(s_InjectedMutex);
+		s_Injected.push_back(task);
+		s_InjectedCount.fetch_add(1, std::memory_order_release);
+	}
+
+	Wake();
+}
+
+static void Unblock(Task* task)
+{
+	if (task->Blockers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		Schedule(task);
+	}
+}
+
+static void Finish(Task* task)
+{
+	if (task->Unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+	{
+		return;
+	}
+
+	// No successors are added after this, so the list can be walked without the lock
+	LockTask(task);
+	task->Finished = true;
+	UnlockTask(task);
+
+	for (Task* successor : task->Successors)
+	{
+		Unblock(successor);
+		Release(successor);
+	}
+
+	if (Task* parent = task->Parent)
+	{
+		Finish(parent);
+		Release(parent);
+	}
+}
+
+static void Execute(Task* task)
+{
+	if (task->Function)
+	{
+		task->Function();
+	}
+
+	Finish(task);
+	Release(task);
+}
+
+static Task* FindTask()
+{
+	u32 self = t_Worker;
+	if (self != ~0u)
+	{
+		if (Task* task = s_Queues[self]->Pop())
+		{
+			return task;
+		}
+	}
+
+	if (s_InjectedCount.load(std::memory_order_acquire) > 0)
+	{
+		std::scoped_lock lock(s_InjectedMutex);
+		if (!s_Injected.empty())
+		{
+			Task* task = s_Injected.back();
+			s_Injected.pop_back();
+			s_InjectedCount.fetch_sub(1, std::memory_order_relaxed);
+			return task;
+		}
+	}
+
+	// Starting at a random victim spreads the thieves out
+	t_Random ^= t_Random << 13;
+	t_Random ^= t_Random >> 17;
+	t_Random ^= t_Random << 5;
+
+	u32 count = u32(s_Queues.size());
+	for (u32 i = 0, victim = t_Random % count; i < count; i++, victim = (victim + 1) % count)
+	{
+		if (victim == self)
+		{
+			continue;
+		}
+
+		if (Task* task = s_Queues[victim]->Steal())
+		{
+			return task;
+		}
+	}
+
+	return nullptr;
+}
+
+static void WorkerLoop(u32 index)
+{
+	t_Worker = index;
+	t_Random += index * 0x6C8E9CF5u;
+
+	while (s_Running.load(std::memory_order_acquire))
+	{
+		if (Task* task = FindTask())
+		{
+			Execute(task);
+			continue;
+		}
+
+		// Anything scheduled after the epoch was read bumps it, so the wait can't miss it
+		s_Sleeping.fetch_add(1, std::memory_order_seq_cst);
+		u64 epoch = s_Epoch.load(std::memory_order_seq_cst);
+		if (Task* task = FindTask())
+		{
+			s_Sleeping.fetch_sub(1, std::memory_order_relaxed);
+			Execute(task);
+			continue;
+		}
+
+		if (s_Running.load(std::memory_order_acquire))
+		{
+			s_Epoch.wait(epoch, std::memory_order_seq_cst);
+		}
+		s_Sleeping.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+
+void Init(u32 workers)
+{
+	if (workers == 0)
+	{
+		workers = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	s_Queues.reserve(workers);
+	for (u32 i = 0; i < workers; i++)
+	{
+		s_Queues.push_back(std::make_unique<WorkQueue>());
+	}
+
+	t_Worker = 0;
+	s_Running = true;
+	s_Threads.reserve(workers - 1);
+	for (u32 i = 1; i < workers; i++)
+	{
+		s_Threads.emplace_back(&WorkerLoop, i);
+	}
+
+	TRACE("Started job system with {} workers", workers);
+}
+
+void Cleanup()
+{
+	s_Running = false;
+	s_Epoch.fetch_add(1, std::memory_order_seq_cst);
+	s_Epoch.notify_all();
+
+	for (auto& thread : s_Threads)
+	{
+		thread.join();
+	}
+
+	// Tasks left in the queues still hold references to their successors and parents, so they are run instead of
+	// just being dropped, which frees all of them
+	while (Task* task = FindTask())
+	{
+		Execute(task);
+	}
+
+	s_Threads.clear();
+	s_Queues.clear();
+	t_Worker = ~0u;
+}
+
+u32 WorkerCount() { return u32(s_Queues.size()); }
+
+u32 WorkerIndex() { return t_Worker; }
+
+TaskHandle::~TaskHandle() { Destroy(); }
+
+TaskHandle::TaskHandle(const TaskHandle& other) : m_Task(other.m_Task)
+{
+	if (m_Task)
+	{
+		m_Task->References.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+TaskHandle& TaskHandle::operator=(const TaskHandle& other)
+{
+	if (other.m_Task)
+	{
+		other.m_Task->References.fetch_add(1, std::memory_order_relaxed);
+	}
+	Destroy();
+
+	m_Task = other.m_Task;
+
+	return *this;
+}
+
+TaskHandle::TaskHandle(TaskHandle&& other)
+{
+	m_Task = other.m_Task;
+	other.m_Task = nullptr;
+}
+
+TaskHandle& TaskHandle::operator=(TaskHandle&& other)
+{
+	Destroy();
+
+	m_Task = other.m_Task;
+	other.m_Task = nullptr;
+
+	return *this;
+}
+
+void TaskHandle::Destroy()
+{
+	if (m_Task)
+	{
+		Release(m_Task);
+	}
+}
+
+TaskHandle Create(std::function<void()> function, const TaskHandle* parent)
+{
+	Task* task = AllocateTask();
+	task->Function = std::move(function);
+
+	if (parent && parent->m_Task)
+	{
+		ASSERT(!IsDone(*parent), "Cannot add a child to a finished task");
+
+		task->Parent = parent->m_Task;
+		task->Parent->Unfinished.fetch_add(1, std::memory_order_relaxed);
+		task->Parent->References.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	return TaskHandle(task);
+}
+
+void DependsOn(const TaskHandle& task, const TaskHandle& dependency)
+{
+	ASSERT(task.m_Task && dependency.m_Task, "Dependencies need valid tasks");
+
+	Task* dep = dependency.m_Task;
+	task.m_Task->Blockers.fetch_add(1, std::memory_order_relaxed);
+
+	LockTask(dep);
+	if (dep->Finished)
+	{
+		UnlockTask(dep);
+		task.m_Task->Blockers.fetch_sub(1, std::memory_order_relaxed);
+		return;
+	}
+
+	task.m_Task->References.fetch_add(1, std::memory_order_relaxed);
+	dep->Successors.push_back(task.m_Task);
+	UnlockTask(dep);
+}
+
+void Submit(const TaskHandle& task)
+{
+	ASSERT(task.m_Task, "Cannot submit an empty task handle");
+
+	// Held by the scheduler until the task has run
+	task.m_Task->References.fetch_add(1, std::memory_order_relaxed);
+	Unblock(task.m_Task);
+}
+
+TaskHandle Run(std::function<void()> function)
+{
+	TaskHandle task = Create(std::move(function));
+	Submit(task);
+
+	return task;
+}
+
+void Wait(const TaskHandle& task)
+{
+	ASSERT(task.m_Task, "Cannot wait on an empty task handle");
+
+	while (!IsDone(task))
+	{
+		if (Task* other = FindTask())
+		{
+			Execute(other);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+bool IsDone(const TaskHandle& task) { return task.m_Task->Unfinished.load(std::memory_order_acquire) == 0; }
+
+void ParallelFor(u64 begin, u64 end, u64 grain, const std::function<void(u64, u64)>& function)
+{
+	if (begin >= end)
+	{
+		return;
+	}
+
+	grain = std::max(grain, u64(1));
+	if (end - begin <= grain || WorkerCount() <= 1)
+	{
+		function(begin, end);
+		return;
+	}
+
+	TaskHandle root = Create(nullptr);
+	for (u64 first = begin; first < end; first += grain)
+	{
+		u64 last = std::min(first + grain, end);
+		Submit(Create([&function, first, last]() { function(first, last); }, &root));
+	}
+
+	Submit(root);
+	Wait(root);
+}
+
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+namespace Jobs {
+
+struct Task;
+
+// Reference counted, a task is only freed once it has finished and no handle refers to it anymore
+class TaskHandle
+{
+public:
+	TaskHandle() = default;
+	~TaskHandle();
+
+	TaskHandle(const TaskHandle& other);
+	TaskHandle& operator=(const TaskHandle& other);
+
+	TaskHandle(TaskHandle&& other);
+	TaskHandle& operator=(TaskHandle&& other);
+
+	bool IsValid() const { return m_Task; }
+
+private:
+	friend TaskHandle Create(std::function<void()> function, const TaskHandle* parent);
+	friend void DependsOn(const TaskHandle& task, const TaskHandle& dependency);
+	friend void Submit(const TaskHandle& task);
+	friend void Wait(const TaskHandle& task);
+	friend bool IsDone(const TaskHandle& task);
+
+	explicit TaskHandle(Task* task) : m_Task(task) {}
+
+	void Destroy();
+
+	Task* m_Task = nullptr;
+};
+
+// The calling thread becomes worker 0 and helps out while waiting, the rest get their own threads. Zero workers uses
+// one per hardware thread.
+void Init(u32 workers = 0);
+void Cleanup();
+
+u32 WorkerCount();
+// The worker running the calling thread, or ~0u for threads the job system doesn't know about
+u32 WorkerIndex();
+
+// A task with a parent only lets the parent finish once it has finished itself. Nothing runs before Submit.
+TaskHandle Create(std::function<void()> function, const TaskHandle* parent = nullptr);
+// Has to be called before the task is submitted, the dependency may be in any state
+void DependsOn(const TaskHandle& task, const TaskHandle& dependency);
+void Submit(const TaskHandle& task);
+TaskHandle Run(std::function<void()> function);
+
+// Runs other tasks until the task and all its children have finished
+void Wait(const TaskHandle& task);
+bool IsDone(const TaskHandle& task);
+
+// Splits [begin, end) into chunks of at most grain elements, and returns once all of them have run
+void ParallelFor(u64 begin, u64 end, u64 grain, const std::function<void(u64, u64)>& function);
+
+};
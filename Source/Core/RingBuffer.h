@@ -0,0 +1,126 @@
+#pragma once
+
+// Bounded queue for exactly one producer and one consumer thread. The blocking calls sleep on the indices instead of
+// spinning, and neither side ever takes a lock.
+template<typename T, u64 Capacity>
+class RingBuffer
+{
+	static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "Ring buffer capacity must be a power of two");
+
+public:
+	bool TryPush(T value)
+	{
+		T* slot = TryReserve();
+		if (!slot)
+		{
+			return false;
+		}
+
+		*slot = std::move(value);
+		Commit();
+		return true;
+	}
+
+	// Blocks while the queue is full
+	void Push(T value)
+	{
+		Reserve() = std::move(value);
+		Commit();
+	}
+
+	std::optional<T> TryPop()
+	{
+		T* slot = TryPeek();
+		if (!slot)
+		{
+			return std::nullopt;
+		}
+
+		T value = std::move(*slot);
+		Release();
+		return value;
+	}
+
+	// Blocks while the queue is empty
+	T Pop()
+	{
+		T value = std::move(Peek());
+		Release();
+		return value;
+	}
+
+	// The in-place versions give out the slot itself, so elements that own allocations are reused instead of being
+	// moved through the queue. A reserved slot is only visible to the consumer after Commit, and a peeked one is
+	// only reused by the producer after Release.
+	T* TryReserve()
+	{
+		u64 write = m_Write.load(std::memory_order_relaxed);
+		if (write - m_Read.load(std::memory_order_acquire) == Capacity)
+		{
+			return nullptr;
+		}
+
+		return &m_Data[write & (Capacity - 1)];
+	}
+
+	T& Reserve()
+	{
+		u64 write = m_Write.load(std::memory_order_relaxed);
+		u64 read = m_Read.load(std::memory_order_acquire);
+		while (write - read == Capacity)
+		{
+			m_Read.wait(read, std::memory_order_acquire);
+			read = m_Read.load(std::memory_order_acquire);
+		}
+
+		return m_Data[write & (Capacity - 1)];
+	}
+
+	void Commit()
+	{
+		m_Write.fetch_add(1, std::memory_order_release);
+		m_Write.notify_one();
+	}
+
+	T* TryPeek()
+	{
+		u64 read = m_Read.load(std::memory_order_relaxed);
+		if (read == m_Write.load(std::memory_order_acquire))
+		{
+			return nullptr;
+		}
+
+		return &m_Data[read & (Capacity - 1)];
+	}
+
+	T& Peek()
+	{
+		u64 read = m_Read.load(std::memory_order_relaxed);
+		u64 write = m_Write.load(std::memory_order_acquire);
+		while (read == write)
+		{
+			m_Write.wait(write, std::memory_order_acquire);
+			write = m_Write.load(std::memory_order_acquire);
+		}
+
+		return m_Data[read & (Capacity - 1)];
+	}
+
+	void Release()
+	{
+		m_Read.fetch_add(1, std::memory_order_release);
+		m_Read.notify_one();
+	}
+
+	u64 GetSize() const
+	{
+		return m_Write.load(std::memory_order_acquire) - m_Read.load(std::memory_order_acquire);
+	}
+
+private:
+	std::array<T, Capacity> m_Data;
+
+	// Kept on separate cache lines, as each is written by a different thread
+	alignas(64) std::atomic<u64> m_Write = 0;
+	alignas(64) std::atomic<u64> m_Read = 0;
+};
@@ -15,35 +15,74 @@ struct WindowHandler
 	~WindowHandler() { Window::Cleanup(); }
 };
 
+// How many windows show the same scene, e.g. --windows 3. Empty if the arguments are invalid.
+static std::optional<u32> ParseWindowCount(int argc, char* argv[])
+{
+	u32 windowCount = 1;
+	for (int arg = 1; arg < argc; arg++)
+	{
+		if (std::string_view(argv[arg]) != "--windows")
+		{
+			continue;
+		}
+		if (arg + 1 == argc)
+		{
+			return std::nullopt;
+		}
+
+		std::string_view value = argv[++arg];
+		auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), windowCount);
+		if (error != std::errc() || end != value.data() + value.size() || windowCount == 0 ||
+			windowCount > App::MaxWindows)
+		{
+			return std::nullopt;
+		}
+	}
+
+	return windowCount;
+}
+
 int main(int argc, char* argv[])
 {
 	std::filesystem::current_path(std::filesystem::path(argv[0]).parent_path());
+	Logger::Init();
+
+	std::optional<u32> windowCount = ParseWindowCount(argc, argv);
+	if (!windowCount)
+	{
+		ERROR("Usage: {} [--windows <count>], with a count from 1 to {}", argv[0], App::MaxWindows);
+		Logger::Cleanup();
+		return 1;
+	}
 
 	try
 	{
-		WindowHandler w;
-		InstanceHandler i;
+		{
+			WindowHandler w;
+			InstanceHandler i;
 
-		App app;
-		app.Run();
+			App app(*windowCount);
+			app.Run();
+		}
 
-		spdlog::shutdown();
+		// Only once everything is torn down, as the debug messenger logs until the device is destroyed
+		Logger::Cleanup();
 
 		return 0;
 	}
 	catch (std::exception& e)
 	{
 		ERROR("Unexpected exception: {}", e.what());
-		spdlog::shutdown();
+		Logger::Cleanup();
 	}
 	catch (int)
 	{
-		spdlog::shutdown();
+		Logger::Cleanup();
 	}
 	catch (...)
 	{
 		ERROR("Unknown exception thrown");
-		spdlog::shutdown();
+		Logger::Cleanup();
 	}
 
 	return 1;
@@ -5,14 +5,19 @@
 #include <algorithm>
 #include <any>
 #include <array>
+#include <bit>
 #include <atomic>
 #include <bitset>
+#include <charconv>
 #include <chrono>
+#include <exception>
 #include <filesystem>
 #include <fstream>
 #include <functional>
 #include <initializer_list>
 #include <memory>
+#include <mutex>
+#include <numeric>
 #include <optional>
 #include <span>
 #include <string>
@@ -0,0 +1,67 @@
+#include "PCH.h"
+
+#include "GpuStatistics.h"
+
+// Results are written in the order of the flag bits, which is the order of the struct members
+static constexpr VkQueryPipelineStatisticFlags StatisticFlags =
+	VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+	VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+	VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+	VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+	VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+	VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+static constexpr u32 StatisticCount = sizeof(PipelineStatistics) / sizeof(u64);
+
+GpuStatistics::GpuStatistics(bool enable)
+{
+	if (!enable)
+	{
+		return;
+	}
+
+	if (!Instance::Features().PipelineStatistics)
+	{
+		WARN("Pipeline statistics queries aren't supported, GPU invocations won't be counted");
+		return;
+	}
+
+	m_Pool = QueryPool(VK_QUERY_TYPE_PIPELINE_STATISTICS, 1, StatisticFlags);
+}
+
+void GpuStatistics::Begin(CommandBuffer& cmd)
+{
+	if (!m_Pool.GetHandle())
+	{
+		return;
+	}
+
+	cmd.ResetQueries(m_Pool, 0, 1);
+	cmd.BeginQuery(m_Pool, 0);
+	m_Pending = true;
+}
+
+void GpuStatistics::End(CommandBuffer& cmd)
+{
+	if (m_Pool.GetHandle())
+	{
+		cmd.EndQuery(m_Pool, 0);
+	}
+}
+
+std::optional<PipelineStatistics> GpuStatistics::Resolve()
+{
+	if (!std::exchange(m_Pending, false))
+	{
+		return std::nullopt;
+	}
+
+	std::array<u64, StatisticCount> results;
+	if (!m_Pool.GetResults(0, 1, results, sizeof(results)))
+	{
+		return std::nullopt;
+	}
+
+	PipelineStatistics statistics;
+	std::memcpy(&statistics, results.data(), sizeof(statistics));
+	return statistics;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Vulkan/Command.h"
+#include "Vulkan/Query.h"
+
+// What the GPU actually ran, as opposed to what was recorded
+struct PipelineStatistics
+{
+	u64 InputVertices = 0;
+	u64 InputPrimitives = 0;
+	u64 VertexInvocations = 0;
+	u64 ClippingPrimitives = 0;
+	u64 FragmentInvocations = 0;
+	u64 ComputeInvocations = 0;
+};
+
+// Counts the pipeline invocations of a whole frame with a single query, begun and ended outside of any render pass.
+// Like the GPU timer, only one frame is counted at a time.
+class GpuStatistics
+{
+public:
+	GpuStatistics() = default;
+	GpuStatistics(bool enable);
+
+	// Begin right after the command buffer begins, and End right before it ends
+	void Begin(CommandBuffer& cmd);
+	void End(CommandBuffer& cmd);
+
+	// Nothing if statistics aren't supported, or nothing was counted since the last call
+	std::optional<PipelineStatistics> Resolve();
+
+private:
+	QueryPool m_Pool;
+	bool m_Pending = false;
+};
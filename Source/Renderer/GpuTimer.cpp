@@ -0,0 +1,74 @@
+#include "PCH.h"
+
+#include "GpuTimer.h"
+
+GpuTimer::GpuTimer(u32 maxScopes)
+{
+	if (!QueryPool::SupportsTimestamps())
+	{
+		WARN("Timestamps aren't supported, GPU times won't be measured");
+		return;
+	}
+
+	// A start and an end timestamp per scope
+	m_Pool = QueryPool(VK_QUERY_TYPE_TIMESTAMP, maxScopes * 2);
+	m_Period = QueryPool::GetTimestampPeriod();
+	m_Names.resize(maxScopes);
+	m_Timestamps.resize(maxScopes * 2);
+}
+
+void GpuTimer::Begin(CommandBuffer& cmd)
+{
+	m_ScopeCount = 0;
+	if (!m_Pool.GetHandle())
+	{
+		return;
+	}
+
+	cmd.ResetQueries(m_Pool, 0, m_Pool.GetCount());
+	m_Pending = true;
+}
+
+u32 GpuTimer::Start(CommandBuffer& cmd, std::string_view name)
+{
+	if (!m_Pool.GetHandle() || m_ScopeCount == m_Names.size())
+	{
+		return ~0u;
+	}
+
+	u32 scope = m_ScopeCount++;
+	m_Names[scope].assign(name);
+	cmd.WriteTimestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_Pool, scope * 2);
+
+	return scope;
+}
+
+void GpuTimer::Stop(CommandBuffer& cmd, u32 scope)
+{
+	if (scope != ~0u)
+	{
+		cmd.WriteTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_Pool, scope * 2 + 1);
+	}
+}
+
+std::span<const GpuTime> GpuTimer::Resolve()
+{
+	m_Results.clear();
+	if (!std::exchange(m_Pending, false) || m_ScopeCount == 0)
+	{
+		return m_Results;
+	}
+
+	if (!m_Pool.GetResults(0, m_ScopeCount * 2, std::span(m_Timestamps.data(), m_ScopeCount * 2)))
+	{
+		return m_Results;
+	}
+
+	for (u32 i = 0; i < m_ScopeCount; i++)
+	{
+		u64 ticks = m_Timestamps[i * 2 + 1] - m_Timestamps[i * 2];
+		m_Results.push_back(GpuTime{ .Name = m_Names[i], .Milliseconds = f64(ticks) * m_Period / 1e6 });
+	}
+
+	return m_Results;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Vulkan/Command.h"
+#include "Vulkan/Query.h"
+
+struct GpuTime
+{
+	std::string_view Name;
+	f64 Milliseconds;
+};
+
+// Times scopes of a frame's commands with timestamp queries. Only one frame is timed at a time, so its results have to
+// be resolved once it has completed on the GPU and before the next frame begins.
+class GpuTimer
+{
+public:
+	GpuTimer() = default;
+	GpuTimer(u32 maxScopes);
+
+	void Begin(CommandBuffer& cmd);
+	// Returns ~0u without timestamp support or once all scopes are used, which Stop ignores
+	u32 Start(CommandBuffer& cmd, std::string_view name);
+	void Stop(CommandBuffer& cmd, u32 scope);
+
+	// Empty if nothing was timed since the last call
+	std::span<const GpuTime> Resolve();
+
+private:
+	QueryPool m_Pool;
+	f64 m_Period = 0.0;
+	bool m_Pending = false;
+
+	u32 m_ScopeCount = 0;
+	std::vector<std::string> m_Names;
+	std::vector<u64> m_Timestamps;
+	std::vector<GpuTime> m_Results;
+};
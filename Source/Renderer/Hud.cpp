@@ -0,0 +1,259 @@
+#include "PCH.h"
+
+#include "Hud.h"
+
+// 5x7 glyphs for ASCII 32 to 95, one row per byte with the leftmost pixel in bit 4
+static constexpr u8 Font[64][7] = {
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // space
+	{ 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 }, // !
+	{ 0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00 }, // "
+	{ 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A }, // #
+	{ 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04 }, // $
+	{ 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 }, // %
+	{ 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D }, // &
+	{ 0x0C, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00 }, // '
+	{ 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 }, // (
+	{ 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 }, // )
+	{ 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 }, // *
+	{ 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 }, // +
+	{ 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 }, // ,
+	{ 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 }, // -
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C }, // .
+	{ 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 }, // /
+	{ 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, // 0
+	{ 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 1
+	{ 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F }, // 2
+	{ 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E }, // 3
+	{ 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 }, // 4
+	{ 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E }, // 5
+	{ 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E }, // 6
+	{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 }, // 7
+	{ 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E }, // 8
+	{ 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }, // 9
+	{ 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 }, // :
+	{ 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 }, // ;
+	{ 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 }, // <
+	{ 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 }, // =
+	{ 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 }, // >
+	{ 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 }, // ?
+	{ 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E }, // @
+	{ 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 }, // A
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E }, // B
+	{ 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E }, // C
+	{ 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C }, // D
+	{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // E
+	{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 }, // F
+	{ 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F }, // G
+	{ 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // H
+	{ 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, // I
+	{ 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C }, // J
+	{ 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, // K
+	{ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F }, // L
+	{ 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 }, // M
+	{ 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, // N
+	{ 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // O
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 }, // P
+	{ 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D }, // Q
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 }, // R
+	{ 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E }, // S
+	{ 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // T
+	{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // U
+	{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // V
+	{ 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A }, // W
+	{ 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 }, // X
+	{ 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 }, // Y
+	{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }, // Z
+	{ 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E }, // [
+	{ 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 }, // backslash
+	{ 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E }, // ]
+	{ 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00 }, // ^
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }, // _
+};
+
+static std::array<Shader, 2> LoadShaders()
+{
+	return { Shader("../Shaders/Hud.vert.spv", VK_SHADER_STAGE_VERTEX_BIT),
+		Shader("../Shaders/Hud.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT) };
+}
+
+static VertexInput GetVertexInput()
+{
+	return VertexInput(
+		VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, { { VK_FORMAT_R32G32_SFLOAT, 0 }, { VK_FORMAT_R8G8B8A8_UNORM, 1 } });
+}
+
+// Lines can go either way, so nothing is culled
+static Rasterizer GetRasterizer()
+{
+	return Rasterizer(VK_FRONT_FACE_COUNTER_CLOCKWISE, VK_FALSE, VK_FALSE, VK_POLYGON_MODE_FILL, 1.f, VK_FALSE);
+}
+
+static BlendState GetBlendState()
+{
+	return BlendState{ { VkPipelineColorBlendAttachmentState{ .blendEnable = VK_TRUE,
+		.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
+		.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+		.colorBlendOp = VK_BLEND_OP_ADD,
+		.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+		.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+		.alphaBlendOp = VK_BLEND_OP_ADD,
+		.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT
+						  | VK_COLOR_COMPONENT_A_BIT } } };
+}
+
+Hud::Hud(const Viewport& viewport, const RenderPass& renderPass, u32 subpass, u32 maxVertices)
+{
+	CreateResources(maxVertices);
+
+	auto shaders = LoadShaders();
+	m_Pipeline = Pipeline(shaders, GetVertexInput(), viewport, GetRasterizer(), Multisample(), DepthStencil(),
+		GetBlendState(), DynamicState{ VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR }, m_Layout, renderPass,
+		subpass);
+}
+
+Hud::Hud(const Viewport& viewport, VkFormat format, u32 maxVertices)
+{
+	CreateResources(maxVertices);
+
+	auto shaders = LoadShaders();
+	m_Pipeline = Pipeline(shaders, GetVertexInput(), viewport, GetRasterizer(), Multisample(), DepthStencil(),
+		GetBlendState(), DynamicState{ VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR }, m_Layout,
+		RenderingFormats{ { format } });
+}
+
+void Hud::CreateResources(u32 maxVertices)
+{
+	m_Capacity = maxVertices;
+	m_Vertices = Buffer(sizeof(HudVertex) * maxVertices, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU,
+		MemoryTag::Other);
+
+	PushRange push[] = { { sizeof(glm::vec2), VK_SHADER_STAGE_VERTEX_BIT } };
+	m_Layout = PipelineLayout({}, push);
+}
+
+void Hud::Begin(glm::vec2 size)
+{
+	m_Size = size;
+	m_Count = 0;
+	m_Mapped = reinterpret_cast<HudVertex*>(m_Vertices.Map());
+}
+
+void Hud::End()
+{
+	m_Vertices.Unmap();
+	m_Vertices.Flush(0, VK_WHOLE_SIZE);
+	m_Mapped = nullptr;
+}
+
+void Hud::Text(glm::vec2 position, std::string_view text, u32 color, f32 scale)
+{
+	glm::vec2 pen = position;
+	for (char c : text)
+	{
+		if (c == '\n')
+		{
+			pen = glm::vec2(position.x, pen.y + LineHeight * scale);
+			continue;
+		}
+
+		c = char(std::toupper(u8(c)));
+		const u8* glyph = Font[c >= 32 && c < 96 ? c - 32 : '?' - 32];
+
+		// Each run of set pixels in a row is a single quad
+		for (u32 row = 0; row < 7; row++)
+		{
+			u32 bits = glyph[row];
+			for (u32 column = 0; column < 5;)
+			{
+				if (!(bits & (0x10 >> column)))
+				{
+					column++;
+					continue;
+				}
+
+				u32 end = column;
+				while (end < 5 && (bits & (0x10 >> end)))
+				{
+					end++;
+				}
+
+				glm::vec2 offset(f32(column), f32(row));
+				Rect(pen + offset * scale, glm::vec2(f32(end - column), 1.f) * scale, color);
+				column = end;
+			}
+		}
+
+		pen.x += Advance * scale;
+	}
+}
+
+void Hud::Rect(glm::vec2 position, glm::vec2 size, u32 color)
+{
+	Quad(position, position + glm::vec2(size.x, 0.f), position + size, position + glm::vec2(0.f, size.y), color);
+}
+
+void Hud::Line(glm::vec2 from, glm::vec2 to, u32 color, f32 width)
+{
+	glm::vec2 direction = to - from;
+	f32 length = glm::length(direction);
+	if (length == 0.f)
+	{
+		return;
+	}
+
+	glm::vec2 side = glm::vec2(-direction.y, direction.x) / length * (width * 0.5f);
+	Quad(from + side, to + side, to - side, from - side, color);
+}
+
+void Hud::Graph(glm::vec2 position, glm::vec2 size, std::span<const f32> values, u64 first, f32 max, u32 color)
+{
+	if (values.size() < 2 || max <= 0.f)
+	{
+		return;
+	}
+
+	f32 step = size.x / f32(values.size() - 1);
+	auto point = [&](u64 i) {
+		f32 value = std::clamp(values[(first + i) % values.size()] / max, 0.f, 1.f);
+		return position + glm::vec2(step * f32(i), size.y * (1.f - value));
+	};
+
+	glm::vec2 last = point(0);
+	for (u64 i = 1; i < values.size(); i++)
+	{
+		glm::vec2 next = point(i);
+		Line(last, next, color);
+		last = next;
+	}
+}
+
+void Hud::Draw(CommandBuffer& cmd) const
+{
+	if (m_Count == 0)
+	{
+		return;
+	}
+
+	cmd.BindPipeline(m_Pipeline);
+	cmd.PushConstants(m_Layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(m_Size), &m_Size);
+	cmd.BindVertexBuffer(m_Vertices, 0);
+	cmd.Draw(m_Count, 1, 0, 0);
+}
+
+void Hud::Quad(glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec2 d, u32 color)
+{
+	// Anything past the end of the buffer is dropped, which only cuts off the overlay
+	if (!m_Mapped || m_Count + 6 > m_Capacity)
+	{
+		return;
+	}
+
+	HudVertex* vertices = m_Mapped + m_Count;
+	vertices[0] = { a, color };
+	vertices[1] = { b, color };
+	vertices[2] = { c, color };
+	vertices[3] = { a, color };
+	vertices[4] = { c, color };
+	vertices[5] = { d, color };
+	m_Count += 6;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Vulkan/Buffer.h"
+#include "Vulkan/Command.h"
+#include "Vulkan/Pipeline.h"
+
+struct HudVertex
+{
+	glm::vec2 Position;
+	u32 Color;
+};
+
+// Text, lines and rectangles drawn over a finished frame. Everything added between Begin and End goes into one vertex
+// buffer and is drawn with a single draw call. Positions are in pixels from the top left corner.
+class Hud
+{
+public:
+	static constexpr f32 GlyphWidth = 5.f;
+	static constexpr f32 GlyphHeight = 7.f;
+	static constexpr f32 Advance = 6.f;
+	static constexpr f32 LineHeight = 9.f;
+
+	Hud() = default;
+	Hud(const Viewport& viewport, const RenderPass& renderPass, u32 subpass, u32 maxVertices = 1 << 16);
+	// For use with CommandBuffer::BeginRendering
+	Hud(const Viewport& viewport, VkFormat format, u32 maxVertices = 1 << 16);
+
+	// Packed like VK_FORMAT_R8G8B8A8_UNORM
+	static constexpr u32 Color(u8 r, u8 g, u8 b, u8 a = 255)
+	{
+		return u32(r) | u32(g) << 8 | u32(b) << 16 | u32(a) << 24;
+	}
+
+	// The vertices of the last frame must not be in use by the GPU anymore
+	void Begin(glm::vec2 size);
+	void End();
+
+	// Lowercase letters are drawn as uppercase ones, and anything the font doesn't have as a question mark
+	void Text(glm::vec2 position, std::string_view text, u32 color, f32 scale = 1.f);
+	void Rect(glm::vec2 position, glm::vec2 size, u32 color);
+	void Line(glm::vec2 from, glm::vec2 to, u32 color, f32 width = 1.f);
+	// Values are read as a ring starting at first, so the oldest is on the left. Max is at the top of the graph.
+	void Graph(glm::vec2 position, glm::vec2 size, std::span<const f32> values, u64 first, f32 max, u32 color);
+
+	// Inside a render pass or rendering scope with the viewport already bound
+	void Draw(CommandBuffer& cmd) const;
+
+private:
+	void CreateResources(u32 maxVertices);
+	void Quad(glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec2 d, u32 color);
+
+	Buffer m_Vertices;
+	HudVertex* m_Mapped = nullptr;
+	u32 m_Count = 0;
+	u32 m_Capacity = 0;
+	glm::vec2 m_Size{};
+
+	PipelineLayout m_Layout;
+	Pipeline m_Pipeline;
+};
@@ -0,0 +1,563 @@
+#include "PCH.h"
+
+#include "RenderGraph.h"
+
+#include "GpuTimer.h"
+#include "Vulkan/Hash.h"
+
+static ResourceState GetState(const ResourceAccess& access)
+{
+	if (access.Access & WriteAccessMask)
+	{
+		return ResourceState{ .Layout = access.Layout,
+			.WriteStages = access.Stages,
+			.WriteAccess = access.Access & WriteAccessMask };
+	}
+
+	return ResourceState{ .Layout = access.Layout, .ReadStages = access.Stages, .ReadAccess = access.Access };
+}
+
+void PassBuilder::Read(GraphResource resource, const ResourceAccess& access)
+{
+	m_Accesses.push_back({ resource, access, false });
+}
+
+void PassBuilder::Write(GraphResource resource, const ResourceAccess& access)
+{
+	m_Accesses.push_back({ resource, access, true });
+}
+
+RenderGraph::~RenderGraph() { Free(); }
+
+RenderGraph& RenderGraph::operator=(RenderGraph&& other)
+{
+	Free();
+
+	m_Resources = std::move(other.m_Resources);
+	m_Passes = std::move(other.m_Passes);
+	m_Barriers = std::move(other.m_Barriers);
+	m_FinalBarriers = std::move(other.m_FinalBarriers);
+	m_Signature = other.m_Signature;
+	m_Blocks = std::move(other.m_Blocks);
+	m_Images = std::move(other.m_Images);
+	m_Views = std::move(other.m_Views);
+	m_Buffers = std::move(other.m_Buffers);
+	m_Memory = std::move(other.m_Memory);
+	other.m_Memory.clear();
+
+	return *this;
+}
+
+GraphResource RenderGraph::CreateImage(std::string name, const GraphImageDesc& desc)
+{
+	Resource& resource = m_Resources.emplace_back();
+	resource.Name = std::move(name);
+	resource.IsImage = true;
+	resource.ImageDesc = desc;
+	resource.Range = VkImageSubresourceRange{ desc.Aspect, 0, desc.MipLevels, 0, desc.Layers };
+
+	return GraphResource(m_Resources.size() - 1);
+}
+
+GraphResource RenderGraph::CreateBuffer(std::string name, const GraphBufferDesc& desc)
+{
+	Resource& resource = m_Resources.emplace_back();
+	resource.Name = std::move(name);
+	resource.IsImage = false;
+	resource.BufferDesc = desc;
+
+	return GraphResource(m_Resources.size() - 1);
+}
+
+GraphResource RenderGraph::ImportImage(std::string name, const Image& image, const ImageView* view,
+	VkImageSubresourceRange range, const ResourceAccess& current, std::optional<ResourceAccess> final)
+{
+	Resource& resource = m_Resources.emplace_back();
+	resource.Name = std::move(name);
+	resource.IsImage = true;
+	resource.ImportedImage = &image;
+	resource.ImportedView = view;
+	resource.Range = range;
+	resource.Initial = GetState(current);
+	resource.Final = final;
+
+	return GraphResource(m_Resources.size() - 1);
+}
+
+GraphResource RenderGraph::ImportBuffer(
+	std::string name, const Buffer& buffer, const ResourceAccess& current, std::optional<ResourceAccess> final)
+{
+	Resource& resource = m_Resources.emplace_back();
+	resource.Name = std::move(name);
+	resource.IsImage = false;
+	resource.ImportedBuffer = &buffer;
+	resource.Initial = GetState(current);
+	resource.Final = final;
+
+	return GraphResource(m_Resources.size() - 1);
+}
+
+GraphResource RenderGraph::ImportTrackedImage(std::string name, Image& image, const ImageView* view,
+	VkImageSubresourceRange range, std::optional<ResourceAccess> final)
+{
+	GraphResource id = ImportImage(std::move(name), image, view, range, Usage::None, final);
+
+	Resource& resource = m_Resources[id];
+	resource.TrackedImage = &image;
+	resource.Initial = image.GetState(range.baseMipLevel, range.baseArrayLayer);
+
+	return id;
+}
+
+GraphResource RenderGraph::ImportTrackedBuffer(std::string name, Buffer& buffer, std::optional<ResourceAccess> final)
+{
+	GraphResource id = ImportBuffer(std::move(name), buffer, Usage::None, final);
+
+	Resource& resource = m_Resources[id];
+	resource.TrackedBuffer = &buffer;
+	resource.Initial = buffer.GetState();
+
+	return id;
+}
+
+void RenderGraph::AddPass(std::string name, const SetupFunc& setup, ExecuteFunc execute)
+{
+	Pass& pass = m_Passes.emplace_back();
+	pass.Name = std::move(name);
+	pass.Execute = std::move(execute);
+	setup(pass.Builder);
+
+	for (const auto& access : pass.Builder.m_Accesses)
+	{
+		ASSERT(access.Resource < m_Resources.size(), "Pass '{}' uses an unknown resource", pass.Name);
+	}
+}
+
+void RenderGraph::Compile()
+{
+	Cull();
+	Allocate();
+	Plan();
+}
+
+void RenderGraph::Execute(CommandBuffer& buffer, GpuTimer* timer) const
+{
+	for (u64 i = 0; i < m_Passes.size(); i++)
+	{
+		if (m_Passes[i].Live)
+		{
+			Emit(buffer, m_Barriers[i]);
+
+			u32 scope = timer ? timer->Start(buffer, m_Passes[i].Name) : ~0u;
+			m_Passes[i].Execute(buffer, *this);
+			if (timer)
+			{
+				timer->Stop(buffer, scope);
+			}
+		}
+	}
+
+	Emit(buffer, m_FinalBarriers);
+
+	for (const auto& resource : m_Resources)
+	{
+		if (resource.TrackedImage)
+		{
+			resource.TrackedImage->SetState(resource.End, resource.Range);
+		}
+		else if (resource.TrackedBuffer)
+		{
+			resource.TrackedBuffer->SetState(resource.End);
+		}
+	}
+}
+
+void RenderGraph::Reset()
+{
+	m_Resources.clear();
+	m_Passes.clear();
+	m_Barriers.clear();
+	m_FinalBarriers = PlannedBarriers();
+}
+
+const Image& RenderGraph::GetImage(GraphResource resource) const
+{
+	const Resource& res = m_Resources[resource];
+	ASSERT(res.IsImage, "Resource '{}' is not an image", res.Name);
+
+	return res.ImportedImage ? *res.ImportedImage : m_Images[res.Storage];
+}
+
+const ImageView& RenderGraph::GetImageView(GraphResource resource) const
+{
+	const Resource& res = m_Resources[resource];
+	ASSERT(res.IsImage, "Resource '{}' is not an image", res.Name);
+
+	if (res.ImportedImage)
+	{
+		ASSERT(res.ImportedView, "Image '{}' was imported without a view", res.Name);
+		return *res.ImportedView;
+	}
+
+	return m_Views[res.Storage];
+}
+
+const Buffer& RenderGraph::GetBuffer(GraphResource resource) const
+{
+	const Resource& res = m_Resources[resource];
+	ASSERT(!res.IsImage, "Resource '{}' is not a buffer", res.Name);
+
+	return res.ImportedBuffer ? *res.ImportedBuffer : m_Buffers[res.Storage];
+}
+
+void RenderGraph::Cull()
+{
+	// Walk backwards from the outputs, a pass is needed if it writes to anything a later needed pass reads
+	std::vector<bool> needed(m_Resources.size());
+	for (u64 i = 0; i < m_Resources.size(); i++)
+	{
+		needed[i] = m_Resources[i].Final.has_value();
+	}
+
+	for (u64 i = m_Passes.size(); i-- > 0;)
+	{
+		Pass& pass = m_Passes[i];
+		pass.Live = pass.Builder.m_SideEffects;
+		for (const auto& access : pass.Builder.m_Accesses)
+		{
+			pass.Live |= access.Write && needed[access.Resource];
+		}
+
+		if (!pass.Live)
+		{
+			TRACE("Culled render graph pass '{}'", pass.Name);
+			continue;
+		}
+
+		for (const auto& access : pass.Builder.m_Accesses)
+		{
+			if (!access.Write)
+			{
+				needed[access.Resource] = true;
+			}
+		}
+	}
+
+	for (u32 i = 0; i < m_Passes.size(); i++)
+	{
+		if (m_Passes[i].Live)
+		{
+			for (const auto& access : m_Passes[i].Builder.m_Accesses)
+			{
+				Resource& resource = m_Resources[access.Resource];
+				resource.FirstPass = std::min(resource.FirstPass, i);
+				resource.LastPass = std::max(resource.LastPass, i);
+			}
+		}
+	}
+}
+
+void RenderGraph::Allocate()
+{
+	std::vector<GraphResource> transients;
+	u32 images = 0;
+	u32 buffers = 0;
+	u64 signature = HashSeed;
+	for (GraphResource i = 0; i < m_Resources.size(); i++)
+	{
+		Resource& resource = m_Resources[i];
+		if (resource.IsImported() || resource.FirstPass == ~0u)
+		{
+			continue;
+		}
+
+		transients.push_back(i);
+		resource.Storage = resource.IsImage ? images++ : buffers++;
+
+		signature = HashValue(signature, resource.IsImage);
+		signature = HashValue(signature, resource.FirstPass);
+		signature = HashValue(signature, resource.LastPass);
+		if (resource.IsImage)
+		{
+			const GraphImageDesc& desc = resource.ImageDesc;
+			signature = HashValue(signature, desc.Format);
+			signature = HashValue(signature, desc.Size.x);
+			signature = HashValue(signature, desc.Size.y);
+			signature = HashValue(signature, desc.Usage);
+			signature = HashValue(signature, desc.Aspect);
+			signature = HashValue(signature, desc.MipLevels);
+			signature = HashValue(signature, desc.Layers);
+			signature = HashValue(signature, desc.Samples);
+		}
+		else
+		{
+			signature = HashValue(signature, resource.BufferDesc.Size);
+			signature = HashValue(signature, resource.BufferDesc.Usage);
+		}
+	}
+
+	if (signature == m_Signature)
+	{
+		for (u64 i = 0; i < transients.size(); i++)
+		{
+			m_Resources[transients[i]].Block = m_Blocks[i];
+		}
+		return;
+	}
+
+	Free();
+	m_Signature = signature;
+
+	std::vector<VkMemoryRequirements> requirements;
+	requirements.reserve(transients.size());
+	for (GraphResource id : transients)
+	{
+		const Resource& resource = m_Resources[id];
+		if (resource.IsImage)
+		{
+			const GraphImageDesc& desc = resource.ImageDesc;
+			const Image& image = m_Images.emplace_back(VK_IMAGE_TYPE_2D, desc.Format,
+				glm::u32vec3(desc.Size, 1), desc.MipLevels, desc.Layers, desc.Samples, desc.Usage, 0);
+			requirements.push_back(image.GetMemoryRequirements());
+		}
+		else
+		{
+			const Buffer& buffer =
+				m_Buffers.emplace_back(Buffer::CreateAliased(resource.BufferDesc.Size, resource.BufferDesc.Usage));
+			requirements.push_back(buffer.GetMemoryRequirements());
+		}
+	}
+
+	// Largest first, so the first resource placed in a block decides its size in most cases
+	std::vector<u64> order(transients.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(),
+		[&](u64 a, u64 b) { return requirements[a].size > requirements[b].size; });
+
+	// Images and buffers are kept in separate blocks, so there is no need to worry about bufferImageGranularity
+	struct MemoryBlock
+	{
+		VkMemoryRequirements Requirements;
+		bool IsImage;
+		std::vector<std::pair<u32, u32>> Lifetimes;
+	};
+	std::vector<MemoryBlock> blocks;
+	m_Blocks.resize(transients.size());
+	for (u64 i : order)
+	{
+		Resource& resource = m_Resources[transients[i]];
+		const VkMemoryRequirements& req = requirements[i];
+
+		auto fits = [&](const MemoryBlock& block) {
+			if (block.IsImage != resource.IsImage || !(block.Requirements.memoryTypeBits & req.memoryTypeBits))
+			{
+				return false;
+			}
+
+			for (auto [first, last] : block.Lifetimes)
+			{
+				if (resource.FirstPass <= last && resource.LastPass >= first)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		};
+
+		auto it = std::find_if(blocks.begin(), blocks.end(), fits);
+		if (it == blocks.end())
+		{
+			blocks.push_back(MemoryBlock{ .Requirements = req, .IsImage = resource.IsImage });
+			it = blocks.end() - 1;
+		}
+		else
+		{
+			it->Requirements.size = std::max(it->Requirements.size, req.size);
+			it->Requirements.alignment = std::max(it->Requirements.alignment, req.alignment);
+			it->Requirements.memoryTypeBits &= req.memoryTypeBits;
+		}
+
+		it->Lifetimes.emplace_back(resource.FirstPass, resource.LastPass);
+		resource.Block = u32(it - blocks.begin());
+		m_Blocks[i] = resource.Block;
+	}
+
+	u64 total = 0;
+	m_Memory.reserve(blocks.size());
+	for (const auto& block : blocks)
+	{
+		VmaAllocationCreateInfo info{ .usage = VMA_MEMORY_USAGE_GPU_ONLY };
+		VkCall(vmaAllocateMemory(
+			Instance::Allocator(), &block.Requirements, &info, &m_Memory.emplace_back(VK_NULL_HANDLE), nullptr));
+		Memory::Track(MemoryTag::RenderTargets, m_Memory.back());
+		total += block.Requirements.size;
+	}
+
+	m_Views.reserve(m_Images.size());
+	for (GraphResource id : transients)
+	{
+		const Resource& resource = m_Resources[id];
+		if (resource.IsImage)
+		{
+			Image& image = m_Images[resource.Storage];
+			image.Bind(m_Memory[resource.Block], 0);
+
+			const GraphImageDesc& desc = resource.ImageDesc;
+			VkImageViewType type = desc.Layers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+			m_Views.emplace_back(image, desc.Format, type,
+				VkComponentMapping{ VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY,
+					VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY },
+				resource.Range);
+		}
+		else
+		{
+			m_Buffers[resource.Storage].Bind(m_Memory[resource.Block], 0);
+		}
+	}
+
+	DEBUG("Render graph placed {} transient resources in {} memory blocks ({} bytes)", transients.size(),
+		blocks.size(), total);
+}
+
+void RenderGraph::Plan()
+{
+	std::vector<ResourceState> states(m_Resources.size());
+	std::vector<bool> initialized(m_Resources.size());
+
+	// The last use of each memory block, which an aliasing resource has to wait on
+	std::vector<std::pair<VkPipelineStageFlags, VkAccessFlags>> blocks(m_Memory.size());
+
+	auto transition = [&](PlannedBarriers& barriers, GraphResource id, const ResourceAccess& use) {
+		const Resource& resource = m_Resources[id];
+		ResourceState& state = states[id];
+		if (!initialized[id])
+		{
+			initialized[id] = true;
+			state = resource.IsImported() ? resource.Initial
+										  : ResourceState{ .WriteStages = blocks[resource.Block].first,
+												.WriteAccess = blocks[resource.Block].second };
+		}
+
+		VkImageLayout layout = resource.IsImage ? use.Layout : VK_IMAGE_LAYOUT_UNDEFINED;
+		if (std::optional<Dependency> dependency = TransitionState(state, layout, use.Access, use.Stages))
+		{
+			if (dependency->From != dependency->To)
+			{
+				barriers.Images.push_back({ id, *dependency });
+			}
+			else
+			{
+				barriers.MemorySourceStages |= dependency->SourceStages;
+				barriers.MemoryDestinationStages |= dependency->DestinationStages;
+				if (dependency->Source)
+				{
+					barriers.MemorySource |= dependency->Source;
+					barriers.MemoryDestination |= dependency->Destination;
+				}
+			}
+		}
+
+		if (!resource.IsImported())
+		{
+			blocks[resource.Block] = { state.WriteStages | state.ReadStages, state.WriteAccess };
+		}
+	};
+
+	m_Barriers.clear();
+	m_Barriers.resize(m_Passes.size());
+	std::vector<PassBuilder::Access> merged;
+	for (u64 i = 0; i < m_Passes.size(); i++)
+	{
+		const Pass& pass = m_Passes[i];
+		if (!pass.Live)
+		{
+			continue;
+		}
+
+		// Multiple uses of one resource in a pass turn into a single transition
+		merged.clear();
+		for (const auto& access : pass.Builder.m_Accesses)
+		{
+			auto it = std::find_if(merged.begin(), merged.end(),
+				[&](const PassBuilder::Access& other) { return other.Resource == access.Resource; });
+			if (it == merged.end())
+			{
+				merged.push_back(access);
+				continue;
+			}
+
+			const Resource& resource = m_Resources[access.Resource];
+			ASSERT(!resource.IsImage || it->Use.Layout == access.Use.Layout,
+				"Pass '{}' uses image '{}' in two different layouts", pass.Name, resource.Name);
+			it->Use.Stages |= access.Use.Stages;
+			it->Use.Access |= access.Use.Access;
+		}
+
+		for (const auto& access : merged)
+		{
+			transition(m_Barriers[i], access.Resource, access.Use);
+		}
+	}
+
+	m_FinalBarriers = PlannedBarriers();
+	for (GraphResource i = 0; i < m_Resources.size(); i++)
+	{
+		Resource& resource = m_Resources[i];
+		if (resource.Final)
+		{
+			transition(m_FinalBarriers, i, *resource.Final);
+		}
+		resource.End = initialized[i] ? states[i] : resource.Initial;
+	}
+}
+
+void RenderGraph::Emit(CommandBuffer& buffer, const PlannedBarriers& barriers) const
+{
+	if (!barriers.MemorySourceStages && !barriers.MemoryDestinationStages && barriers.Images.empty())
+	{
+		return;
+	}
+
+	static thread_local std::vector<ImageBarrier> images;
+	images.clear();
+	images.reserve(barriers.Images.size());
+	for (const auto& barrier : barriers.Images)
+	{
+		images.push_back(ImageBarrier{ .Source = barrier.Dep.Source,
+			.Destination = barrier.Dep.Destination,
+			.From = barrier.Dep.From,
+			.To = barrier.Dep.To,
+			.Img = GetImage(barrier.Resource).GetHandle(),
+			.Range = m_Resources[barrier.Resource].Range,
+			.SourceStage = barrier.Dep.SourceStages,
+			.DestinationStage = barrier.Dep.DestinationStages });
+	}
+
+	MemoryBarrier memory{ .Source = barriers.MemorySource,
+		.Destination = barriers.MemoryDestination,
+		.SourceStage = barriers.MemorySourceStages,
+		.DestinationStage = barriers.MemoryDestinationStages };
+	std::span<MemoryBarrier> memorySpan;
+	if (barriers.MemorySourceStages || barriers.MemoryDestinationStages)
+	{
+		memorySpan = std::span(&memory, 1);
+	}
+
+	buffer.PipelineBarrier(0, memorySpan, {}, images);
+}
+
+void RenderGraph::Free()
+{
+	m_Views.clear();
+	m_Images.clear();
+	m_Buffers.clear();
+	for (VmaAllocation memory : m_Memory)
+	{
+		Memory::Untrack(MemoryTag::RenderTargets, memory);
+		vmaFreeMemory(Instance::Allocator(), memory);
+	}
+	m_Memory.clear();
+	m_Blocks.clear();
+	m_Signature = 0;
+}
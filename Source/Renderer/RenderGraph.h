@@ -0,0 +1,221 @@
+#pragma once
+
+#include "Vulkan/Buffer.h"
+#include "Vulkan/Command.h"
+#include "Vulkan/Image.h"
+
+class GpuTimer;
+
+using GraphResource = u32;
+
+// How a pass uses a resource. Layout is ignored for buffers.
+struct ResourceAccess
+{
+	VkPipelineStageFlags Stages;
+	VkAccessFlags Access;
+	VkImageLayout Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+};
+
+namespace Usage {
+
+constexpr ResourceAccess None{ VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED };
+
+constexpr ResourceAccess ColorAttachment{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+	VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+	VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+constexpr ResourceAccess DepthAttachment{
+	VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+	VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+	VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+};
+constexpr ResourceAccess DepthRead{
+	VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+	VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+};
+
+constexpr ResourceAccess SampledVertex{ VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+	VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+constexpr ResourceAccess SampledFragment{ VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+	VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+constexpr ResourceAccess SampledCompute{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+	VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+constexpr ResourceAccess StorageReadCompute{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+	VK_IMAGE_LAYOUT_GENERAL };
+constexpr ResourceAccess StorageWriteCompute{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+	VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL };
+
+constexpr ResourceAccess TransferSource{ VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+	VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL };
+constexpr ResourceAccess TransferDestination{ VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+	VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL };
+
+constexpr ResourceAccess VertexBuffer{ VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT };
+constexpr ResourceAccess IndexBuffer{ VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT };
+constexpr ResourceAccess IndirectBuffer{ VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+	VK_ACCESS_INDIRECT_COMMAND_READ_BIT };
+constexpr ResourceAccess UniformBuffer{
+	VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_UNIFORM_READ_BIT
+};
+
+constexpr ResourceAccess Present{ VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR };
+
+};
+
+struct GraphImageDesc
+{
+	VkFormat Format;
+	glm::u32vec2 Size;
+	VkImageUsageFlags Usage;
+	VkImageAspectFlags Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+	u32 MipLevels = 1;
+	u32 Layers = 1;
+	VkSampleCountFlagBits Samples = VK_SAMPLE_COUNT_1_BIT;
+};
+
+struct GraphBufferDesc
+{
+	u64 Size;
+	VkBufferUsageFlags Usage;
+};
+
+class PassBuilder
+{
+public:
+	void Read(GraphResource resource, const ResourceAccess& access);
+	void Write(GraphResource resource, const ResourceAccess& access);
+
+	// Passes that load the previous contents of a resource they write must also read it.
+	// Passes with side effects (e.g. writing to a host readable buffer) are never culled.
+	void SetSideEffects() { m_SideEffects = true; }
+
+private:
+	friend class RenderGraph;
+
+	struct Access
+	{
+		GraphResource Resource;
+		ResourceAccess Use;
+		bool Write;
+	};
+
+	std::vector<Access> m_Accesses;
+	bool m_SideEffects = false;
+};
+
+// Passes are declared every frame, and executed in declaration order after culling the ones that don't contribute
+// to an imported resource with a final access, or have side effects. Transient resources with non-overlapping
+// lifetimes share memory, and are kept alive between frames as long as the declarations stay the same.
+class RenderGraph
+{
+public:
+	using SetupFunc = std::function<void(PassBuilder&)>;
+	using ExecuteFunc = std::function<void(CommandBuffer&, const RenderGraph&)>;
+
+	RenderGraph() = default;
+	~RenderGraph();
+
+	RenderGraph(const RenderGraph& other) = delete;
+	RenderGraph& operator=(const RenderGraph& other) = delete;
+
+	RenderGraph(RenderGraph&& other) = default;
+	RenderGraph& operator=(RenderGraph&& other);
+
+	GraphResource CreateImage(std::string name, const GraphImageDesc& desc);
+	GraphResource CreateBuffer(std::string name, const GraphBufferDesc& desc);
+
+	// The graph transitions the resource from current to final, if given. The state is not tracked further, so
+	// current must be correct every time the graph is compiled.
+	GraphResource ImportImage(std::string name, const Image& image, const ImageView* view,
+		VkImageSubresourceRange range, const ResourceAccess& current,
+		std::optional<ResourceAccess> final = std::nullopt);
+	GraphResource ImportBuffer(std::string name, const Buffer& buffer, const ResourceAccess& current,
+		std::optional<ResourceAccess> final = std::nullopt);
+
+	// Starts from the tracked state of the resource, and updates it when the graph is executed
+	GraphResource ImportTrackedImage(std::string name, Image& image, const ImageView* view,
+		VkImageSubresourceRange range, std::optional<ResourceAccess> final = std::nullopt);
+	GraphResource ImportTrackedBuffer(
+		std::string name, Buffer& buffer, std::optional<ResourceAccess> final = std::nullopt);
+
+	void AddPass(std::string name, const SetupFunc& setup, ExecuteFunc execute);
+
+	// Transient resources may be recreated here, so the GPU must be done with any previous execution of the graph
+	void Compile();
+	// Times every pass with the timer if there is one
+	void Execute(CommandBuffer& buffer, GpuTimer* timer = nullptr) const;
+
+	// Clears all passes and resources, but keeps the transient memory around for the next frame
+	void Reset();
+
+	const Image& GetImage(GraphResource resource) const;
+	const ImageView& GetImageView(GraphResource resource) const;
+	const Buffer& GetBuffer(GraphResource resource) const;
+
+private:
+	struct Resource
+	{
+		std::string Name;
+		bool IsImage;
+		GraphImageDesc ImageDesc;
+		GraphBufferDesc BufferDesc;
+
+		const Image* ImportedImage = nullptr;
+		const ImageView* ImportedView = nullptr;
+		const Buffer* ImportedBuffer = nullptr;
+		Image* TrackedImage = nullptr;
+		Buffer* TrackedBuffer = nullptr;
+		VkImageSubresourceRange Range;
+		ResourceState Initial;
+		ResourceState End;
+		std::optional<ResourceAccess> Final;
+
+		u32 FirstPass = ~0u;
+		u32 LastPass = 0;
+		u32 Storage = ~0u;
+		u32 Block = ~0u;
+
+		bool IsImported() const { return ImportedImage || ImportedBuffer; }
+	};
+
+	struct Pass
+	{
+		std::string Name;
+		PassBuilder Builder;
+		ExecuteFunc Execute;
+		bool Live = false;
+	};
+
+	struct PlannedImageBarrier
+	{
+		GraphResource Resource;
+		Dependency Dep;
+	};
+
+	// Buffer dependencies and execution-only ones are merged into a single memory barrier
+	struct PlannedBarriers
+	{
+		VkPipelineStageFlags MemorySourceStages = 0;
+		VkPipelineStageFlags MemoryDestinationStages = 0;
+		VkAccessFlags MemorySource = 0;
+		VkAccessFlags MemoryDestination = 0;
+		std::vector<PlannedImageBarrier> Images;
+	};
+
+	void Cull();
+	void Allocate();
+	void Plan();
+	void Emit(CommandBuffer& buffer, const PlannedBarriers& barriers) const;
+	void Free();
+
+	std::vector<Resource> m_Resources;
+	std::vector<Pass> m_Passes;
+	std::vector<PlannedBarriers> m_Barriers;
+	PlannedBarriers m_FinalBarriers;
+
+	u64 m_Signature = 0;
+	std::vector<u32> m_Blocks;
+	std::vector<Image> m_Images;
+	std::vector<ImageView> m_Views;
+	std::vector<Buffer> m_Buffers;
+	std::vector<VmaAllocation> m_Memory;
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+struct RenderObject
+{
+	glm::mat4 Transform;
+};
+
+// Snapshot of everything drawn in a frame. Built by the simulation and only read by the render thread afterwards, so
+// transforms are final by the time they get there.
+struct RenderList
+{
+	glm::mat4 View;
+
+	// The aspect ratio depends on the swapchain, which is only resized on the render thread
+	f32 FieldOfView;
+	f32 Near;
+	f32 Far;
+
+	std::vector<RenderObject> Objects;
+
+	// Keeps the allocations, as lists are reused every other frame
+	void Clear() { Objects.clear(); }
+};
@@ -0,0 +1,175 @@
+#include "PCH.h"
+
+#include "StaticGeometry.h"
+
+// The draws follow the vertex and index data in the staging buffer, which only ends on a multiple of the vertex stride
+static u64 GetDrawsOffset(u64 pendingSize)
+{
+	constexpr u64 Alignment = alignof(VkDrawIndexedIndirectCommand);
+	return (pendingSize + Alignment - 1) / Alignment * Alignment;
+}
+
+StaticGeometry::StaticGeometry(u32 vertexStride, u32 maxVertices, u32 maxIndices, u32 maxMeshes)
+	: m_VertexStride(vertexStride),
+	  m_Vertices(u64(vertexStride) * maxVertices, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		  VMA_MEMORY_USAGE_GPU_ONLY, MemoryTag::Meshes),
+	  m_Indices(u64(sizeof(u32)) * maxIndices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		  VMA_MEMORY_USAGE_GPU_ONLY, MemoryTag::Meshes),
+	  m_Draws(sizeof(VkDrawIndexedIndirectCommand) * maxMeshes,
+		  VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY,
+		  MemoryTag::Meshes),
+	  m_MaxMeshes(maxMeshes)
+{
+	ASSERT(maxVertices <= u32(INT32_MAX), "Vertex offsets must fit into 31 bits");
+}
+
+u32 StaticGeometry::Add(std::span<const u8> vertices, std::span<const u32> indices)
+{
+	ASSERT(!vertices.empty() && vertices.size() % m_VertexStride == 0, "Vertex data must be whole vertices");
+	ASSERT(!indices.empty(), "Mesh has no indices");
+
+	// Aligned to the stride, so the offset is a whole number of vertices
+	std::optional<BufferSlice> vertexSlice = m_Vertices.Allocate(vertices.size(), m_VertexStride);
+	std::optional<BufferSlice> indexSlice = m_Indices.Allocate(indices.size_bytes(), sizeof(u32));
+	if (!vertexSlice || !indexSlice)
+	{
+		if (vertexSlice)
+		{
+			m_Vertices.Free(*vertexSlice);
+		}
+		if (indexSlice)
+		{
+			m_Indices.Free(*indexSlice);
+		}
+		CRITICAL("Static geometry is out of space for a mesh with {} vertices and {} indices",
+			vertices.size() / m_VertexStride, indices.size());
+	}
+
+	u32 mesh;
+	if (m_FreeMeshes.empty())
+	{
+		ASSERT(m_Meshes.size() < m_MaxMeshes, "Static geometry can only hold {} meshes", m_MaxMeshes);
+		mesh = u32(m_Meshes.size());
+		m_Meshes.emplace_back();
+	}
+	else
+	{
+		mesh = m_FreeMeshes.back();
+		m_FreeMeshes.pop_back();
+	}
+
+	m_Meshes[mesh] = Mesh{ .Range = MeshRange{ .FirstIndex = u32(indexSlice->Offset / sizeof(u32)),
+							   .VertexOffset = i32(vertexSlice->Offset / m_VertexStride),
+							   .IndexCount = u32(indices.size()) },
+		.Vertices = *vertexSlice,
+		.Indices = *indexSlice };
+
+	u64 offset = m_Pending.size();
+	m_Pending.insert(m_Pending.end(), vertices.begin(), vertices.end());
+	m_VertexCopies.push_back(VkBufferCopy{ offset, vertexSlice->Offset, vertexSlice->Size });
+
+	offset = m_Pending.size();
+	auto indexBytes = std::as_bytes(indices);
+	m_Pending.resize(offset + indexBytes.size());
+	std::memcpy(m_Pending.data() + offset, indexBytes.data(), indexBytes.size());
+	m_IndexCopies.push_back(VkBufferCopy{ offset, indexSlice->Offset, indexSlice->Size });
+
+	m_Dirty = true;
+	return mesh;
+}
+
+void StaticGeometry::Remove(u32 mesh)
+{
+	Mesh& m = m_Meshes[mesh];
+	ASSERT(m.Range.IndexCount != 0, "Mesh was already removed");
+
+	m_Vertices.Free(m.Vertices);
+	m_Indices.Free(m.Indices);
+	m = Mesh{};
+	m_FreeMeshes.push_back(mesh);
+
+	m_Dirty = true;
+}
+
+u64 StaticGeometry::GetUploadSize() const
+{
+	return m_Dirty ? GetDrawsOffset(m_Pending.size()) + sizeof(VkDrawIndexedIndirectCommand) * m_Meshes.size() : 0;
+}
+
+void StaticGeometry::Upload(RenderGraph& graph, Buffer& staging)
+{
+	if (!m_Dirty)
+	{
+		return;
+	}
+
+	ASSERT(staging.GetSize() >= GetUploadSize(), "Staging buffer is too small for the upload");
+
+	// The draws are rewritten every time, as removed meshes leave holes that must not draw anything anymore
+	u64 drawsOffset = GetDrawsOffset(m_Pending.size());
+	u8* data = reinterpret_cast<u8*>(staging.Map());
+	std::memcpy(data, m_Pending.data(), m_Pending.size());
+	auto draws = reinterpret_cast<VkDrawIndexedIndirectCommand*>(data + drawsOffset);
+	for (u64 i = 0; i < m_Meshes.size(); i++)
+	{
+		const MeshRange& range = m_Meshes[i].Range;
+		draws[i] = VkDrawIndexedIndirectCommand{ .indexCount = range.IndexCount,
+			.instanceCount = 1,
+			.firstIndex = range.FirstIndex,
+			.vertexOffset = range.VertexOffset,
+			.firstInstance = 0 };
+	}
+	staging.Unmap();
+	staging.Flush(0, VK_WHOLE_SIZE);
+
+	GraphResource vertices = graph.ImportTrackedBuffer("Static vertices", m_Vertices.GetBuffer(), Usage::VertexBuffer);
+	GraphResource indices = graph.ImportTrackedBuffer("Static indices", m_Indices.GetBuffer(), Usage::IndexBuffer);
+	GraphResource drawBuffer = graph.ImportTrackedBuffer("Static draws", m_Draws, Usage::IndirectBuffer);
+	graph.AddPass(
+		"Upload static geometry",
+		[&](PassBuilder& pass) {
+			pass.Write(vertices, Usage::TransferDestination);
+			pass.Write(indices, Usage::TransferDestination);
+			pass.Write(drawBuffer, Usage::TransferDestination);
+		},
+		[this, &staging, vertexCopies = std::move(m_VertexCopies), indexCopies = std::move(m_IndexCopies),
+			drawCopy = VkBufferCopy{ drawsOffset, 0, sizeof(VkDrawIndexedIndirectCommand) * m_Meshes.size() }](
+			CommandBuffer& cmd, const RenderGraph&) mutable {
+			if (!vertexCopies.empty())
+			{
+				cmd.CopyBuffer(staging, m_Vertices.GetBuffer(), vertexCopies);
+				cmd.CopyBuffer(staging, m_Indices.GetBuffer(), indexCopies);
+			}
+			if (drawCopy.size != 0)
+			{
+				cmd.CopyBuffer(staging, m_Draws, std::span(&drawCopy, 1));
+			}
+		});
+
+	m_Pending.clear();
+	m_VertexCopies.clear();
+	m_IndexCopies.clear();
+	m_Dirty = false;
+}
+
+void StaticGeometry::Bind(CommandBuffer& cmd) const
+{
+	cmd.BindVertexBuffer(m_Vertices.GetBuffer(), 0);
+	cmd.BindIndexBuffer(m_Indices.GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
+}
+
+void StaticGeometry::Draw(CommandBuffer& cmd, u32 mesh, u32 instanceCount, u32 firstInstance) const
+{
+	const MeshRange& range = m_Meshes[mesh].Range;
+	cmd.DrawIndexed(range.IndexCount, instanceCount, range.FirstIndex, range.VertexOffset, firstInstance);
+}
+
+void StaticGeometry::DrawAll(CommandBuffer& cmd) const
+{
+	ASSERT(!m_Dirty, "Static geometry has to be uploaded before it is drawn");
+
+	if (!m_Meshes.empty())
+	{
+		cmd.DrawIndexedIndirect(m_Draws, 0, u32(m_Meshes.size()), sizeof(VkDrawIndexedIndirectCommand));
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Renderer/RenderGraph.h"
+
+#include "Vulkan/BufferArena.h"
+#include "Vulkan/Command.h"
+
+// Where a mesh is in the shared buffers, as taken by DrawIndexed
+struct MeshRange
+{
+	u32 FirstIndex = 0;
+	i32 VertexOffset = 0;
+	u32 IndexCount = 0;
+};
+
+// Meshes of one vertex format merged into a single vertex and index buffer pair at load time, so a whole static scene
+// is drawn with one bind and either a DrawIndexed per mesh or one indirect draw for all of them. Indices are 32 bit
+// and relative to the first vertex of their mesh.
+class StaticGeometry
+{
+public:
+	StaticGeometry() = default;
+	StaticGeometry(u32 vertexStride, u32 maxVertices, u32 maxIndices, u32 maxMeshes);
+
+	StaticGeometry(const StaticGeometry& other) = delete;
+	StaticGeometry& operator=(const StaticGeometry& other) = delete;
+
+	// Meshes point into the arenas, so only empty geometry may be moved
+	StaticGeometry(StaticGeometry&& other) = default;
+	StaticGeometry& operator=(StaticGeometry&& other) = default;
+
+	// The data is only copied to the GPU by the next upload, the returned mesh can't be drawn before that
+	u32 Add(std::span<const u8> vertices, std::span<const u32> indices);
+	// The GPU must be done drawing the mesh. Its space can be reused right away.
+	void Remove(u32 mesh);
+
+	const MeshRange& GetMesh(u32 mesh) const { return m_Meshes[mesh].Range; }
+	u32 GetMeshCount() const { return u32(m_Meshes.size()); }
+
+	// Staging bytes the next upload needs, zero if nothing changed since the last one
+	u64 GetUploadSize() const;
+	// Writes everything added since the last upload to the staging buffer, and adds a pass copying it over. The
+	// staging buffer has to stay alive until the GPU is done with the graph.
+	void Upload(RenderGraph& graph, Buffer& staging);
+
+	void Bind(CommandBuffer& cmd) const;
+	void Draw(CommandBuffer& cmd, u32 mesh, u32 instanceCount = 1, u32 firstInstance = 0) const;
+	// Every mesh with one indirect draw, as of the last upload
+	void DrawAll(CommandBuffer& cmd) const;
+
+	// For registering with the defragmenter, meshes stay valid when the buffers are moved
+	Buffer& GetVertexBuffer() { return m_Vertices.GetBuffer(); }
+	Buffer& GetIndexBuffer() { return m_Indices.GetBuffer(); }
+	Buffer& GetDrawBuffer() { return m_Draws; }
+
+private:
+	struct Mesh
+	{
+		MeshRange Range;
+		BufferSlice Vertices;
+		BufferSlice Indices;
+	};
+
+	u32 m_VertexStride = 0;
+	BufferArena m_Vertices;
+	BufferArena m_Indices;
+	// One VkDrawIndexedIndirectCommand per mesh, removed meshes draw nothing
+	Buffer m_Draws;
+	u32 m_MaxMeshes = 0;
+
+	std::vector<Mesh> m_Meshes;
+	std::vector<u32> m_FreeMeshes;
+
+	// Everything added since the last upload, and where it goes
+	std::vector<u8> m_Pending;
+	std::vector<VkBufferCopy> m_VertexCopies;
+	std::vector<VkBufferCopy> m_IndexCopies;
+	bool m_Dirty = false;
+};
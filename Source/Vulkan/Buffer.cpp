@@ -2,21 +2,79 @@
 
 #include "Buffer.h"
 
-Buffer::Buffer(u64 size, VkBufferUsageFlags usage, VmaMemoryUsage memUsage, VkBufferCreateFlags flags)
+Buffer::Buffer(u64 size, VkBufferUsageFlags usage, VmaMemoryUsage memUsage, MemoryTag tag, VkBufferCreateFlags flags)
+	: Buffer(size, usage, tag, flags)
+{
+	VkResult result = Allocate(memUsage, 0);
+	if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY || result == VK_ERROR_OUT_OF_HOST_MEMORY)
+	{
+		Memory::OutOfMemory(result, tag, fmt::format("a {} byte buffer", size));
+	}
+	VkCall(result);
+}
+
+std::optional<Buffer> Buffer::TryCreate(
+	u64 size, VkBufferUsageFlags usage, VmaMemoryUsage memUsage, MemoryTag tag, VkBufferCreateFlags flags)
+{
+	Buffer buffer(size, usage, tag, flags);
+	VkResult result = buffer.Allocate(memUsage, Memory::GetBudgetFlags());
+	if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY || result == VK_ERROR_OUT_OF_HOST_MEMORY)
+	{
+		DEBUG("No memory left within the budget for a {} byte {} buffer", size, Memory::GetTagName(tag));
+		return std::nullopt;
+	}
+	VkCall(result);
+
+	return buffer;
+}
+
+Buffer Buffer::CreateAliased(u64 size, VkBufferUsageFlags usage, VkBufferCreateFlags flags)
+{
+	Buffer buffer(size, usage, MemoryTag::Other, flags);
+	buffer.m_Aliased = true;
+	buffer.CreateHandle();
+	return buffer;
+}
+
+Buffer::Buffer(u64 size, VkBufferUsageFlags usage, MemoryTag tag, VkBufferCreateFlags flags)
+	: m_Tag(tag), m_Size(size), m_Usage(usage), m_Flags(flags)
+{}
+
+VkResult Buffer::Allocate(VmaMemoryUsage memUsage, VmaAllocationCreateFlags allocFlags)
 {
 	u32 index = Instance::GraphicsIndex();
 
 	VkBufferCreateInfo info{ .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-		.flags = flags,
-		.size = size,
-		.usage = usage,
+		.flags = m_Flags,
+		.size = m_Size,
+		.usage = m_Usage,
 		.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
 		.queueFamilyIndexCount = 1,
 		.pQueueFamilyIndices = &index };
 
-	VmaAllocationCreateInfo allocInfo{ .usage = memUsage };
+	VmaAllocationCreateInfo allocInfo{ .flags = allocFlags, .usage = memUsage };
+
+	VkResult result = vmaCreateBuffer(Instance::Allocator(), &info, &allocInfo, &m_Buffer, &m_Memory, nullptr);
+	if (result == VK_SUCCESS)
+	{
+		Memory::Track(m_Tag, m_Memory);
+	}
+	return result;
+}
+
+void Buffer::CreateHandle()
+{
+	u32 index = Instance::GraphicsIndex();
+
+	VkBufferCreateInfo info{ .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		.flags = m_Flags,
+		.size = m_Size,
+		.usage = m_Usage,
+		.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+		.queueFamilyIndexCount = 1,
+		.pQueueFamilyIndices = &index };
 
-	VkCall(vmaCreateBuffer(Instance::Allocator(), &info, &allocInfo, &m_Buffer, &m_Memory, nullptr));
+	VkCall(vkCreateBuffer(Instance::Device(), &info, nullptr, &m_Buffer));
 }
 
 void* Buffer::Map()
@@ -32,7 +90,7 @@ void Buffer::Flush(u64 offset, u64 size) { vmaFlushAllocation(Instance::Allocato
 
 void Buffer::Pull(u64 offset, u64 size) { vmaInvalidateAllocation(Instance::Allocator(), m_Memory, offset, size); }
 
-Buffer::~Buffer() { vmaDestroyBuffer(Instance::Allocator(), m_Buffer, m_Memory); }
+Buffer::~Buffer() { Destroy(); }
 
 Buffer::Buffer(Buffer&& other)
 {
@@ -40,16 +98,63 @@ Buffer::Buffer(Buffer&& other)
 	other.m_Buffer = VK_NULL_HANDLE;
 	m_Memory = other.m_Memory;
 	other.m_Memory = VK_NULL_HANDLE;
+	m_Aliased = other.m_Aliased;
+	m_Tag = other.m_Tag;
+	m_Size = other.m_Size;
+	m_Usage = other.m_Usage;
+	m_Flags = other.m_Flags;
+	m_State = other.m_State;
 }
 
 Buffer& Buffer::operator=(Buffer&& other)
 {
-	this->~Buffer();
+	Destroy();
 
 	m_Buffer = other.m_Buffer;
 	other.m_Buffer = VK_NULL_HANDLE;
 	m_Memory = other.m_Memory;
 	other.m_Memory = VK_NULL_HANDLE;
+	m_Aliased = other.m_Aliased;
+	m_Tag = other.m_Tag;
+	m_Size = other.m_Size;
+	m_Usage = other.m_Usage;
+	m_Flags = other.m_Flags;
+	m_State = other.m_State;
 
 	return *this;
 }
+
+void Buffer::Destroy()
+{
+	if (m_Aliased)
+	{
+		vkDestroyBuffer(Instance::Device(), m_Buffer, nullptr);
+	}
+	else
+	{
+		Memory::Untrack(m_Tag, m_Memory);
+		vmaDestroyBuffer(Instance::Allocator(), m_Buffer, m_Memory);
+	}
+}
+
+VkMemoryRequirements Buffer::GetMemoryRequirements() const
+{
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(Instance::Device(), m_Buffer, &requirements);
+	return requirements;
+}
+
+void Buffer::Bind(VmaAllocation memory, u64 offset)
+{
+	ASSERT(m_Aliased, "Only buffers created without memory can be bound");
+
+	m_Memory = memory;
+	VkCall(vmaBindBufferMemory2(Instance::Allocator(), m_Memory, offset, m_Buffer, nullptr));
+}
+
+void Buffer::Recreate()
+{
+	vkDestroyBuffer(Instance::Device(), m_Buffer, nullptr);
+	CreateHandle();
+	VkCall(vmaBindBufferMemory(Instance::Allocator(), m_Memory, m_Buffer));
+}
@@ -1,14 +1,22 @@
 #pragma once
 
 #include "Instance.h"
+#include "Memory.h"
+#include "ResourceState.h"
 
 class Buffer
 {
 public:
 	Buffer() = default;
-	Buffer(u64 size, VkBufferUsageFlags usage, VmaMemoryUsage memUsage, VkBufferCreateFlags flags = 0);
+	Buffer(u64 size, VkBufferUsageFlags usage, VmaMemoryUsage memUsage, MemoryTag tag, VkBufferCreateFlags flags = 0);
 	~Buffer();
 
+	// Empty instead of going over the memory budget, for content that can be streamed in again later
+	static std::optional<Buffer> TryCreate(u64 size, VkBufferUsageFlags usage, VmaMemoryUsage memUsage, MemoryTag tag,
+		VkBufferCreateFlags flags = 0);
+	// A buffer without any memory, which has to be bound to shared memory with Bind() before use
+	static Buffer CreateAliased(u64 size, VkBufferUsageFlags usage, VkBufferCreateFlags flags = 0);
+
 	Buffer(const Buffer& other) = delete;
 	Buffer& operator=(const Buffer& other) = delete;
 
@@ -23,8 +31,44 @@ public:
 
 	VkBuffer GetHandle() const { return m_Buffer; }
 	VmaAllocation GetMemory() const { return m_Memory; }
+	MemoryTag GetTag() const { return m_Tag; }
+	u64 GetSize() const { return m_Size; }
+
+	VkMemoryRequirements GetMemoryRequirements() const;
+	void Bind(VmaAllocation memory, u64 offset);
+
+	// Tracked as of the last recorded command buffer, so command buffers must be submitted in recording order
+	const ResourceState& GetState() const { return m_State; }
+	void SetState(const ResourceState& state) { m_State = state; }
 
 private:
+	friend class Defragmenter;
+
+	void Destroy();
+
+	Buffer(u64 size, VkBufferUsageFlags usage, MemoryTag tag, VkBufferCreateFlags flags);
+
+	VkResult Allocate(VmaMemoryUsage memUsage, VmaAllocationCreateFlags allocFlags);
+	void CreateHandle();
+	// Makes a new handle bound to wherever the memory is now, after it was moved
+	void Recreate();
+
 	VkBuffer m_Buffer = VK_NULL_HANDLE;
 	VmaAllocation m_Memory = VK_NULL_HANDLE;
+	bool m_Aliased = false;
+	MemoryTag m_Tag = MemoryTag::Other;
+	u64 m_Size = 0;
+	VkBufferUsageFlags m_Usage = 0;
+	VkBufferCreateFlags m_Flags = 0;
+	ResourceState m_State;
+};
+
+// A range of a buffer, usually handed out by a BufferArena
+struct BufferSlice
+{
+	const Buffer* Target = nullptr;
+	u64 Offset = 0;
+	u64 Size = 0;
+	// The arena block the range came from, for giving it back
+	u32 Block = ~0u;
 };
@@ -0,0 +1,236 @@
+#include "PCH.h"
+
+#include "BufferArena.h"
+
+BufferArena::BufferArena(u64 size, VkBufferUsageFlags usage, VmaMemoryUsage memUsage, MemoryTag tag)
+	: m_Buffer(size, usage, memUsage, tag)
+{
+	m_Heads.fill(Null);
+	Insert(CreateBlock(0, size));
+}
+
+std::optional<BufferSlice> BufferArena::Allocate(u64 size, u64 alignment)
+{
+	ASSERT(size != 0, "Cannot allocate an empty range");
+	ASSERT(alignment != 0, "Alignment must not be zero");
+
+	// Any block in the bin fits, even with the worst case padding in front
+	u32 bin = FindBin(size + alignment - 1);
+	if (bin == Null)
+	{
+		return std::nullopt;
+	}
+
+	u32 block = m_Heads[bin];
+	Remove(block);
+
+	u64 padding = (m_Blocks[block].Offset + alignment - 1) / alignment * alignment - m_Blocks[block].Offset;
+	if (padding != 0)
+	{
+		// The padding stays behind as a free block of its own, the previous block can't be free as free neighbours
+		// are always merged
+		Split(block, padding);
+		u32 padded = block;
+		block = m_Blocks[padded].NextPhysical;
+		Remove(block);
+		Insert(padded);
+	}
+
+	if (m_Blocks[block].Size > size)
+	{
+		Split(block, size);
+	}
+
+	m_Blocks[block].Free = false;
+	m_UsedBytes += m_Blocks[block].Size;
+	m_AllocationCount++;
+
+	return BufferSlice{ .Target = &m_Buffer, .Offset = m_Blocks[block].Offset, .Size = size, .Block = block };
+}
+
+void BufferArena::Free(const BufferSlice& slice)
+{
+	ASSERT(slice.Target == &m_Buffer, "Slice is not from this arena");
+
+	u32 block = slice.Block;
+	ASSERT(!m_Blocks[block].Free, "Slice was already freed");
+
+	m_UsedBytes -= m_Blocks[block].Size;
+	m_AllocationCount--;
+
+	u32 prev = m_Blocks[block].PrevPhysical;
+	if (prev != Null && m_Blocks[prev].Free)
+	{
+		Remove(prev);
+		m_Blocks[prev].Size += m_Blocks[block].Size;
+		m_Blocks[prev].NextPhysical = m_Blocks[block].NextPhysical;
+		if (m_Blocks[block].NextPhysical != Null)
+		{
+			m_Blocks[m_Blocks[block].NextPhysical].PrevPhysical = prev;
+		}
+		DestroyBlock(block);
+		block = prev;
+	}
+
+	u32 next = m_Blocks[block].NextPhysical;
+	if (next != Null && m_Blocks[next].Free)
+	{
+		Remove(next);
+		m_Blocks[block].Size += m_Blocks[next].Size;
+		m_Blocks[block].NextPhysical = m_Blocks[next].NextPhysical;
+		if (m_Blocks[next].NextPhysical != Null)
+		{
+			m_Blocks[m_Blocks[next].NextPhysical].PrevPhysical = block;
+		}
+		DestroyBlock(next);
+	}
+
+	Insert(block);
+}
+
+// Same mapping as Histogram, so a bin only holds sizes within 1/16th of each other
+u32 BufferArena::GetBin(u64 size)
+{
+	if (size < SubCount)
+	{
+		return u32(size);
+	}
+
+	u32 exponent = u32(std::bit_width(size)) - 1;
+	u32 shift = exponent - SubBits;
+	return (shift + 1) * SubCount + u32((size >> shift) - SubCount);
+}
+
+u64 BufferArena::GetBinSize(u32 bin)
+{
+	if (bin < SubCount)
+	{
+		return bin;
+	}
+
+	u32 shift = bin / SubCount - 1;
+	return u64(SubCount + bin % SubCount) << shift;
+}
+
+u32 BufferArena::FindBin(u64 size) const
+{
+	// Blocks are filed under the bin their size rounds down to, so the search starts at the first bin where every
+	// block is large enough
+	u32 bin = GetBin(size);
+	if (GetBinSize(bin) < size)
+	{
+		bin++;
+	}
+
+	u32 level = bin / SubCount;
+	if (level >= LevelCount)
+	{
+		return Null;
+	}
+
+	u32 bins = m_Bins[level] & (~0u << (bin % SubCount));
+	if (bins == 0)
+	{
+		u64 levels = level + 1 < 64 ? m_Levels & (~u64(0) << (level + 1)) : 0;
+		if (levels == 0)
+		{
+			return Null;
+		}
+
+		level = u32(std::countr_zero(levels));
+		bins = m_Bins[level];
+	}
+
+	return level * SubCount + u32(std::countr_zero(bins));
+}
+
+u32 BufferArena::CreateBlock(u64 offset, u64 size)
+{
+	u32 block;
+	if (m_UnusedBlocks.empty())
+	{
+		block = u32(m_Blocks.size());
+		m_Blocks.emplace_back();
+	}
+	else
+	{
+		block = m_UnusedBlocks.back();
+		m_UnusedBlocks.pop_back();
+		m_Blocks[block] = Block{};
+	}
+
+	m_Blocks[block].Offset = offset;
+	m_Blocks[block].Size = size;
+	return block;
+}
+
+void BufferArena::DestroyBlock(u32 block) { m_UnusedBlocks.push_back(block); }
+
+void BufferArena::Insert(u32 block)
+{
+	u32 bin = GetBin(m_Blocks[block].Size);
+
+	Block& b = m_Blocks[block];
+	b.Free = true;
+	b.PrevFree = Null;
+	b.NextFree = m_Heads[bin];
+	if (b.NextFree != Null)
+	{
+		m_Blocks[b.NextFree].PrevFree = block;
+	}
+
+	m_Heads[bin] = block;
+	m_Bins[bin / SubCount] |= 1u << (bin % SubCount);
+	m_Levels |= u64(1) << (bin / SubCount);
+}
+
+void BufferArena::Remove(u32 block)
+{
+	u32 bin = GetBin(m_Blocks[block].Size);
+
+	Block& b = m_Blocks[block];
+	if (b.PrevFree != Null)
+	{
+		m_Blocks[b.PrevFree].NextFree = b.NextFree;
+	}
+	else
+	{
+		m_Heads[bin] = b.NextFree;
+	}
+
+	if (b.NextFree != Null)
+	{
+		m_Blocks[b.NextFree].PrevFree = b.PrevFree;
+	}
+
+	b.Free = false;
+	b.PrevFree = Null;
+	b.NextFree = Null;
+
+	if (m_Heads[bin] == Null)
+	{
+		m_Bins[bin / SubCount] &= ~(1u << (bin % SubCount));
+		if (m_Bins[bin / SubCount] == 0)
+		{
+			m_Levels &= ~(u64(1) << (bin / SubCount));
+		}
+	}
+}
+
+void BufferArena::Split(u32 block, u64 size)
+{
+	u32 rest = CreateBlock(m_Blocks[block].Offset + size, m_Blocks[block].Size - size);
+
+	Block& b = m_Blocks[block];
+	m_Blocks[rest].PrevPhysical = block;
+	m_Blocks[rest].NextPhysical = b.NextPhysical;
+	if (b.NextPhysical != Null)
+	{
+		m_Blocks[b.NextPhysical].PrevPhysical = rest;
+	}
+
+	b.NextPhysical = rest;
+	b.Size = size;
+
+	Insert(rest);
+}
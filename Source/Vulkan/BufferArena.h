@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Buffer.h"
+
+// Hands out ranges of one large buffer with a two level segregated fit allocator, so thousands of small meshes share
+// a single VkBuffer instead of each having their own. Allocating and freeing are constant time, and freed ranges are
+// merged with free neighbours right away.
+class BufferArena
+{
+public:
+	BufferArena() = default;
+	BufferArena(u64 size, VkBufferUsageFlags usage, VmaMemoryUsage memUsage, MemoryTag tag);
+
+	BufferArena(const BufferArena& other) = delete;
+	BufferArena& operator=(const BufferArena& other) = delete;
+
+	// Slices point at the arena's buffer, so it must not be moved while any are in use
+	BufferArena(BufferArena&& other) = default;
+	BufferArena& operator=(BufferArena&& other) = default;
+
+	// The offset is a multiple of the alignment, which doesn't have to be a power of two so ranges can start on a
+	// whole vertex. Empty when there is no free range large enough.
+	std::optional<BufferSlice> Allocate(u64 size, u64 alignment = 1);
+	void Free(const BufferSlice& slice);
+
+	Buffer& GetBuffer() { return m_Buffer; }
+	const Buffer& GetBuffer() const { return m_Buffer; }
+
+	u64 GetUsedBytes() const { return m_UsedBytes; }
+	u64 GetFreeBytes() const { return m_Buffer.GetSize() - m_UsedBytes; }
+	u32 GetAllocationCount() const { return m_AllocationCount; }
+
+private:
+	static constexpr u32 Null = ~0u;
+
+	// Sizes are split into power of two ranges, and each of those into SubCount linear bins
+	static constexpr u32 SubBits = 4;
+	static constexpr u32 SubCount = 1 << SubBits;
+	static constexpr u32 LevelCount = 64 - SubBits + 1;
+
+	struct Block
+	{
+		u64 Offset;
+		u64 Size;
+		// Neighbours in the buffer, and in the bin while free
+		u32 PrevPhysical = Null;
+		u32 NextPhysical = Null;
+		u32 PrevFree = Null;
+		u32 NextFree = Null;
+		bool Free = false;
+	};
+
+	static u32 GetBin(u64 size);
+	static u64 GetBinSize(u32 bin);
+
+	u32 FindBin(u64 size) const;
+	u32 CreateBlock(u64 offset, u64 size);
+	void DestroyBlock(u32 block);
+	void Insert(u32 block);
+	void Remove(u32 block);
+	// Splits everything past size off into a new free block
+	void Split(u32 block, u64 size);
+
+	Buffer m_Buffer;
+
+	std::vector<Block> m_Blocks;
+	std::vector<u32> m_UnusedBlocks;
+
+	// A bit per level with any free block, and per level a bit per bin with any free block
+	u64 m_Levels = 0;
+	std::array<u32, LevelCount> m_Bins{};
+	std::array<u32, LevelCount * SubCount> m_Heads{};
+
+	u64 m_UsedBytes = 0;
+	u32 m_AllocationCount = 0;
+};
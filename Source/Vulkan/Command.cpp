@@ -6,8 +6,11 @@
 #include "Description.h"
 #include "Descriptor.h"
 #include "Framebuffer.h"
+#include "Image.h"
 #include "Pipeline.h"
 #include "PipelineLayout.h"
+#include "Query.h"
+#include "Sync.h"
 
 CommandBuffer::CommandBuffer(VkCommandPool pool, VkCommandBufferLevel level) : m_Pool(pool)
 {
@@ -19,8 +22,24 @@ CommandBuffer::CommandBuffer(VkCommandPool pool, VkCommandBufferLevel level) : m
 	VkCall(vkAllocateCommandBuffers(Instance::Device(), &info, &m_Buffer));
 }
 
+CommandStats& CommandStats::operator+=(const CommandStats& other)
+{
+	Draws += other.Draws;
+	Dispatches += other.Dispatches;
+	Vertices += other.Vertices;
+	Triangles += other.Triangles;
+	PipelineBinds += other.PipelineBinds;
+	DescriptorBinds += other.DescriptorBinds;
+	Barriers += other.Barriers;
+	Copies += other.Copies;
+
+	return *this;
+}
+
 void CommandBuffer::Begin(VkCommandBufferUsageFlags flags, std::optional<InheritanceInfo> inInfo)
 {
+	m_Stats = CommandStats();
+
 	VkCommandBufferBeginInfo info{ .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, .flags = flags };
 	VkCommandBufferInheritanceInfo iInfo{};
 	if (inInfo)
@@ -35,7 +54,11 @@ void CommandBuffer::Begin(VkCommandBufferUsageFlags flags, std::optional<Inherit
 	VkCall(vkBeginCommandBuffer(m_Buffer, &info));
 }
 
-void CommandBuffer::End() { VkCall(vkEndCommandBuffer(m_Buffer)); }
+void CommandBuffer::End()
+{
+	FlushBarriers();
+	VkCall(vkEndCommandBuffer(m_Buffer));
+}
 
 void CommandBuffer::BeginRenderPass(const RenderPass& renderPass, const Framebuffer& framebuffer, VkRect2D area,
 	std::span<VkClearValue> clearValues, VkSubpassContents contents)
@@ -47,14 +70,65 @@ void CommandBuffer::BeginRenderPass(const RenderPass& renderPass, const Framebuf
 		.clearValueCount = u32(clearValues.size()),
 		.pClearValues = clearValues.data() };
 
+	FlushBarriers();
 	vkCmdBeginRenderPass(m_Buffer, &info, contents);
 }
 
 void CommandBuffer::EndRenderPass() { vkCmdEndRenderPass(m_Buffer); }
 
+static VkRenderingAttachmentInfoKHR GetAttachmentInfo(const RenderingAttachment& attachment)
+{
+	return VkRenderingAttachmentInfoKHR{ .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
+		.imageView = attachment.View.GetHandle(),
+		.imageLayout = attachment.Layout,
+		.resolveMode = VK_RESOLVE_MODE_NONE,
+		.loadOp = attachment.Load,
+		.storeOp = attachment.Store,
+		.clearValue = attachment.Clear };
+}
+
+void CommandBuffer::BeginRendering(VkRect2D area, std::span<RenderingAttachment> color,
+	std::optional<RenderingAttachment> depth, std::optional<RenderingAttachment> stencil, u32 layers)
+{
+	static thread_local std::vector<VkRenderingAttachmentInfoKHR> colorInfos;
+
+	colorInfos.clear();
+	colorInfos.reserve(color.size());
+	for (const auto& attachment : color)
+	{
+		colorInfos.push_back(GetAttachmentInfo(attachment));
+	}
+
+	VkRenderingAttachmentInfoKHR depthInfo, stencilInfo;
+	if (depth)
+	{
+		depthInfo = GetAttachmentInfo(depth.value());
+	}
+	if (stencil)
+	{
+		stencilInfo = GetAttachmentInfo(stencil.value());
+	}
+
+	VkRenderingInfoKHR info{ .sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR,
+		.renderArea = area,
+		.layerCount = layers,
+		.viewMask = 0,
+		.colorAttachmentCount = u32(colorInfos.size()),
+		.pColorAttachments = colorInfos.data(),
+		.pDepthAttachment = depth ? &depthInfo : nullptr,
+		.pStencilAttachment = stencil ? &stencilInfo : nullptr };
+
+	FlushBarriers();
+	vkCmdBeginRenderingKHR(m_Buffer, &info);
+}
+
+void CommandBuffer::EndRendering() { vkCmdEndRenderingKHR(m_Buffer); }
+
 void CommandBuffer::BindPipeline(const Pipeline& pipeline)
 {
 	vkCmdBindPipeline(m_Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.GetHandle());
+	m_Topology = pipeline.GetTopology();
+	m_Stats.PipelineBinds++;
 }
 
 void CommandBuffer::BindViewport(const Viewport& viewport)
@@ -63,6 +137,33 @@ void CommandBuffer::BindViewport(const Viewport& viewport)
 	vkCmdSetScissor(m_Buffer, 0, 1, &viewport.GetScissor());
 }
 
+void CommandBuffer::SetCullMode(VkCullModeFlags mode) { vkCmdSetCullModeEXT(m_Buffer, mode); }
+
+void CommandBuffer::SetFrontFace(VkFrontFace face) { vkCmdSetFrontFaceEXT(m_Buffer, face); }
+
+void CommandBuffer::SetPrimitiveTopology(VkPrimitiveTopology topology)
+{
+	vkCmdSetPrimitiveTopologyEXT(m_Buffer, topology);
+	m_Topology = topology;
+}
+
+void CommandBuffer::SetDepthTest(VkBool32 enable, VkBool32 write, VkCompareOp compareOp)
+{
+	vkCmdSetDepthTestEnableEXT(m_Buffer, enable);
+	vkCmdSetDepthWriteEnableEXT(m_Buffer, write);
+	vkCmdSetDepthCompareOpEXT(m_Buffer, compareOp);
+}
+
+void CommandBuffer::SetDepthBoundsTest(VkBool32 enable) { vkCmdSetDepthBoundsTestEnableEXT(m_Buffer, enable); }
+
+void CommandBuffer::SetStencilTest(VkBool32 enable) { vkCmdSetStencilTestEnableEXT(m_Buffer, enable); }
+
+void CommandBuffer::SetStencilOp(
+	VkStencilFaceFlags faces, VkStencilOp fail, VkStencilOp pass, VkStencilOp depthFail, VkCompareOp compareOp)
+{
+	vkCmdSetStencilOpEXT(m_Buffer, faces, fail, pass, depthFail, compareOp);
+}
+
 void CommandBuffer::BindVertexBuffer(const Buffer& buffer, u64 offset)
 {
 	VkBuffer buf = buffer.GetHandle();
@@ -74,6 +175,13 @@ void CommandBuffer::BindIndexBuffer(const Buffer& buffer, u64 offset, VkIndexTyp
 	vkCmdBindIndexBuffer(m_Buffer, buffer.GetHandle(), offset, type);
 }
 
+void CommandBuffer::BindVertexBuffer(const BufferSlice& slice) { BindVertexBuffer(*slice.Target, slice.Offset); }
+
+void CommandBuffer::BindIndexBuffer(const BufferSlice& slice, VkIndexType type)
+{
+	BindIndexBuffer(*slice.Target, slice.Offset, type);
+}
+
 void CommandBuffer::BindDescriptorSet(
 	const PipelineLayout& layout, u32 index, const DescriptorSet& set, std::optional<u32> dynamicOffset)
 {
@@ -81,22 +189,282 @@ void CommandBuffer::BindDescriptorSet(
 
 	vkCmdBindDescriptorSets(m_Buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout.GetHandle(), index, 1, &s,
 		dynamicOffset ? 1 : 0, dynamicOffset ? &dynamicOffset.value() : nullptr);
+	m_Stats.DescriptorBinds++;
+}
+
+void CommandBuffer::PushConstants(
+	const PipelineLayout& layout, VkShaderStageFlags stages, u32 offset, u32 size, const void* data)
+{
+	vkCmdPushConstants(m_Buffer, layout.GetHandle(), stages, offset, size, data);
 }
 
 void CommandBuffer::CopyBuffer(const Buffer& from, const Buffer& to, std::span<VkBufferCopy> regions)
 {
+	FlushBarriers();
 	vkCmdCopyBuffer(m_Buffer, from.GetHandle(), to.GetHandle(), u32(regions.size()), regions.data());
+	m_Stats.Copies++;
 }
 
 void CommandBuffer::CopyBufferToImage(
 	const Buffer& from, const Image& to, VkImageLayout currLayout, std::span<VkBufferImageCopy> regions)
 {
+	FlushBarriers();
 	vkCmdCopyBufferToImage(m_Buffer, from.GetHandle(), to.GetHandle(), currLayout, u32(regions.size()), regions.data());
+	m_Stats.Copies++;
+}
+
+static VkPipelineStageFlags GetLegacyStages(VkPipelineStageFlags2KHR stages, VkPipelineStageFlags fallback)
+{
+	ASSERT(!(stages >> 32), "Pipeline stages require Synchronization2");
+	return stages ? VkPipelineStageFlags(stages) : fallback;
+}
+
+static VkMemoryBarrier2KHR GetBarrier2(const MemoryBarrier& mem)
+{
+	return VkMemoryBarrier2KHR{ .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2_KHR,
+		.srcStageMask = mem.SourceStage,
+		.srcAccessMask = mem.Source,
+		.dstStageMask = mem.DestinationStage,
+		.dstAccessMask = mem.Destination };
+}
+
+static VkBufferMemoryBarrier2KHR GetBarrier2(const BufferBarrier& buf)
+{
+	return VkBufferMemoryBarrier2KHR{ .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR,
+		.srcStageMask = buf.SourceStage,
+		.srcAccessMask = buf.Source,
+		.dstStageMask = buf.DestinationStage,
+		.dstAccessMask = buf.Destination,
+		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.buffer = buf.Buf,
+		.offset = buf.Offset,
+		.size = buf.Size };
+}
+
+static VkImageMemoryBarrier2KHR GetBarrier2(const ImageBarrier& img)
+{
+	return VkImageMemoryBarrier2KHR{ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
+		.srcStageMask = img.SourceStage,
+		.srcAccessMask = img.Source,
+		.dstStageMask = img.DestinationStage,
+		.dstAccessMask = img.Destination,
+		.oldLayout = img.From,
+		.newLayout = img.To,
+		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.image = img.Img,
+		.subresourceRange = img.Range };
 }
 
 void CommandBuffer::PipelineBarrier(VkPipelineStageFlags source, VkPipelineStageFlags destination,
 	VkDependencyFlags dependency, std::span<MemoryBarrier> memory, std::span<BufferBarrier> buffers,
 	std::span<ImageBarrier> images)
+{
+	FlushBarriers();
+	RecordLegacyBarriers(source, destination, dependency, memory, buffers, images);
+	m_Stats.Barriers += u32(memory.size() + buffers.size() + images.size());
+}
+
+void CommandBuffer::PipelineBarrier(VkDependencyFlags dependency, std::span<MemoryBarrier> memory,
+	std::span<BufferBarrier> buffers, std::span<ImageBarrier> images)
+{
+	FlushBarriers();
+	RecordBarriers(dependency, memory, buffers, images);
+	m_Stats.Barriers += u32(memory.size() + buffers.size() + images.size());
+}
+
+void CommandBuffer::Transition(Image& image, VkImageLayout layout, VkAccessFlags access, VkPipelineStageFlags stages,
+	std::optional<VkImageSubresourceRange> range)
+{
+	stages = stages ? stages : StagesForAccess(access);
+	VkImageSubresourceRange full = image.GetFullRange();
+	VkImageSubresourceRange r = range.value_or(full);
+	if (r.levelCount == VK_REMAINING_MIP_LEVELS)
+	{
+		r.levelCount = full.levelCount - r.baseMipLevel;
+	}
+	if (r.layerCount == VK_REMAINING_ARRAY_LAYERS)
+	{
+		r.layerCount = full.layerCount - r.baseArrayLayer;
+	}
+
+	// Barriers within one call aren't ordered, so an earlier transition of the same image has to be recorded first
+	VkImage handle = image.GetHandle();
+	if (std::any_of(m_PendingImages.begin(), m_PendingImages.end(),
+			[handle](const ImageBarrier& barrier) { return barrier.Img == handle; }))
+	{
+		FlushBarriers();
+	}
+
+	auto transition = [&](VkImageSubresourceRange sub) {
+		ResourceState state = image.GetState(sub.baseMipLevel, sub.baseArrayLayer);
+		std::optional<Dependency> dependency = TransitionState(state, layout, access, stages);
+		image.SetState(state, sub);
+		if (!dependency)
+		{
+			return;
+		}
+
+		if (dependency->From != dependency->To || dependency->Source)
+		{
+			m_PendingImages.push_back(ImageBarrier{ .Source = dependency->Source,
+				.Destination = dependency->Destination,
+				.From = dependency->From,
+				.To = dependency->To,
+				.Img = handle,
+				.Range = sub,
+				.SourceStage = dependency->SourceStages,
+				.DestinationStage = dependency->DestinationStages });
+		}
+		else
+		{
+			m_PendingMemory.push_back(MemoryBarrier{ .Source = 0,
+				.Destination = 0,
+				.SourceStage = dependency->SourceStages,
+				.DestinationStage = dependency->DestinationStages });
+		}
+	};
+
+	// Usually the whole range is in the same state, so one barrier covers it
+	const ResourceState& first = image.GetState(r.baseMipLevel, r.baseArrayLayer);
+	bool uniform = true;
+	for (u32 layer = r.baseArrayLayer; layer < r.baseArrayLayer + r.layerCount; layer++)
+	{
+		for (u32 level = r.baseMipLevel; level < r.baseMipLevel + r.levelCount; level++)
+		{
+			uniform &= image.GetState(level, layer) == first;
+		}
+	}
+
+	if (uniform)
+	{
+		transition(r);
+		return;
+	}
+
+	for (u32 layer = r.baseArrayLayer; layer < r.baseArrayLayer + r.layerCount; layer++)
+	{
+		for (u32 level = r.baseMipLevel; level < r.baseMipLevel + r.levelCount; level++)
+		{
+			transition(VkImageSubresourceRange{ r.aspectMask, level, 1, layer, 1 });
+		}
+	}
+}
+
+void CommandBuffer::Transition(Buffer& buffer, VkAccessFlags access, VkPipelineStageFlags stages)
+{
+	stages = stages ? stages : StagesForAccess(access);
+
+	VkBuffer handle = buffer.GetHandle();
+	if (std::any_of(m_PendingBuffers.begin(), m_PendingBuffers.end(),
+			[handle](const BufferBarrier& barrier) { return barrier.Buf == handle; }))
+	{
+		FlushBarriers();
+	}
+
+	ResourceState state = buffer.GetState();
+	std::optional<Dependency> dependency = TransitionState(state, VK_IMAGE_LAYOUT_UNDEFINED, access, stages);
+	buffer.SetState(state);
+	if (!dependency)
+	{
+		return;
+	}
+
+	// Write after read only needs an execution dependency
+	if (dependency->Source)
+	{
+		m_PendingBuffers.push_back(BufferBarrier{ .Source = dependency->Source,
+			.Destination = dependency->Destination,
+			.Buf = handle,
+			.Offset = 0,
+			.Size = VK_WHOLE_SIZE,
+			.SourceStage = dependency->SourceStages,
+			.DestinationStage = dependency->DestinationStages });
+	}
+	else
+	{
+		m_PendingMemory.push_back(MemoryBarrier{ .Source = 0,
+			.Destination = 0,
+			.SourceStage = dependency->SourceStages,
+			.DestinationStage = dependency->DestinationStages });
+	}
+}
+
+void CommandBuffer::FlushBarriers()
+{
+	if (m_PendingMemory.empty() && m_PendingBuffers.empty() && m_PendingImages.empty())
+	{
+		return;
+	}
+
+	RecordBarriers(0, m_PendingMemory, m_PendingBuffers, m_PendingImages);
+	m_Stats.Barriers += u32(m_PendingMemory.size() + m_PendingBuffers.size() + m_PendingImages.size());
+
+	m_PendingMemory.clear();
+	m_PendingBuffers.clear();
+	m_PendingImages.clear();
+}
+
+void CommandBuffer::RecordBarriers(VkDependencyFlags dependency, std::span<MemoryBarrier> memory,
+	std::span<BufferBarrier> buffers, std::span<ImageBarrier> images)
+{
+	if (!Instance::Features().Synchronization2)
+	{
+		VkPipelineStageFlags2KHR source = 0;
+		VkPipelineStageFlags2KHR destination = 0;
+		auto combine = [&](const auto& barrier) {
+			source |= barrier.SourceStage;
+			destination |= barrier.DestinationStage;
+		};
+		std::for_each(memory.begin(), memory.end(), combine);
+		std::for_each(buffers.begin(), buffers.end(), combine);
+		std::for_each(images.begin(), images.end(), combine);
+
+		RecordLegacyBarriers(GetLegacyStages(source, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT),
+			GetLegacyStages(destination, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT), dependency, memory, buffers, images);
+		return;
+	}
+
+	static thread_local std::vector<VkMemoryBarrier2KHR> memoryBarriers;
+	static thread_local std::vector<VkBufferMemoryBarrier2KHR> bufferBarriers;
+	static thread_local std::vector<VkImageMemoryBarrier2KHR> imageBarriers;
+
+	memoryBarriers.clear();
+	bufferBarriers.clear();
+	imageBarriers.clear();
+	memoryBarriers.reserve(memory.size());
+	bufferBarriers.reserve(buffers.size());
+	imageBarriers.reserve(images.size());
+
+	for (const auto& mem : memory)
+	{
+		memoryBarriers.push_back(GetBarrier2(mem));
+	}
+	for (const auto& buf : buffers)
+	{
+		bufferBarriers.push_back(GetBarrier2(buf));
+	}
+	for (const auto& img : images)
+	{
+		imageBarriers.push_back(GetBarrier2(img));
+	}
+
+	VkDependencyInfoKHR info{ .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR,
+		.dependencyFlags = dependency,
+		.memoryBarrierCount = u32(memoryBarriers.size()),
+		.pMemoryBarriers = memoryBarriers.data(),
+		.bufferMemoryBarrierCount = u32(bufferBarriers.size()),
+		.pBufferMemoryBarriers = bufferBarriers.data(),
+		.imageMemoryBarrierCount = u32(imageBarriers.size()),
+		.pImageMemoryBarriers = imageBarriers.data() };
+
+	vkCmdPipelineBarrier2KHR(m_Buffer, &info);
+}
+
+void CommandBuffer::RecordLegacyBarriers(VkPipelineStageFlags source, VkPipelineStageFlags destination,
+	VkDependencyFlags dependency, std::span<MemoryBarrier> memory, std::span<BufferBarrier> buffers,
+	std::span<ImageBarrier> images)
 {
 	static thread_local std::vector<VkMemoryBarrier> memoryBarriers;
 	static thread_local std::vector<VkBufferMemoryBarrier> bufferBarriers;
@@ -121,7 +489,7 @@ void CommandBuffer::PipelineBarrier(VkPipelineStageFlags source, VkPipelineStage
 			.dstAccessMask = buf.Destination,
 			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
 			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-			.buffer = buf.Buf.GetHandle(),
+			.buffer = buf.Buf,
 			.offset = buf.Offset,
 			.size = buf.Size });
 	}
@@ -134,7 +502,7 @@ void CommandBuffer::PipelineBarrier(VkPipelineStageFlags source, VkPipelineStage
 			.newLayout = img.To,
 			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
 			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-			.image = img.Img.GetHandle(),
+			.image = img.Img,
 			.subresourceRange = img.Range });
 	}
 
@@ -142,42 +510,265 @@ void CommandBuffer::PipelineBarrier(VkPipelineStageFlags source, VkPipelineStage
 		u32(bufferBarriers.size()), bufferBarriers.data(), u32(imageBarriers.size()), imageBarriers.data());
 }
 
+void CommandBuffer::SignalEvent(GpuEvent& event, std::span<MemoryBarrier> memory, std::span<BufferBarrier> buffers,
+	std::span<ImageBarrier> images)
+{
+	FlushBarriers();
+
+	event.m_Memory.clear();
+	event.m_Buffers.clear();
+	event.m_Images.clear();
+	VkPipelineStageFlags2KHR source = 0;
+	for (const auto& mem : memory)
+	{
+		source |= event.m_Memory.emplace_back(GetBarrier2(mem)).srcStageMask;
+	}
+	for (const auto& buf : buffers)
+	{
+		source |= event.m_Buffers.emplace_back(GetBarrier2(buf)).srcStageMask;
+	}
+	for (const auto& img : images)
+	{
+		source |= event.m_Images.emplace_back(GetBarrier2(img)).srcStageMask;
+	}
+
+	if (Instance::Features().Synchronization2)
+	{
+		VkDependencyInfoKHR info{ .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR,
+			.memoryBarrierCount = u32(event.m_Memory.size()),
+			.pMemoryBarriers = event.m_Memory.data(),
+			.bufferMemoryBarrierCount = u32(event.m_Buffers.size()),
+			.pBufferMemoryBarriers = event.m_Buffers.data(),
+			.imageMemoryBarrierCount = u32(event.m_Images.size()),
+			.pImageMemoryBarriers = event.m_Images.data() };
+		vkCmdSetEvent2KHR(m_Buffer, event.GetHandle(), &info);
+	}
+	else
+	{
+		vkCmdSetEvent(m_Buffer, event.GetHandle(), GetLegacyStages(source, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT));
+	}
+}
+
+void CommandBuffer::WaitEvents(std::span<GpuEvent*> events)
+{
+	FlushBarriers();
+
+	static thread_local std::vector<VkEvent> handles;
+	handles.clear();
+	handles.reserve(events.size());
+	for (const auto event : events)
+	{
+		handles.push_back(event->GetHandle());
+		m_Stats.Barriers += u32(event->m_Memory.size() + event->m_Buffers.size() + event->m_Images.size());
+	}
+
+	if (Instance::Features().Synchronization2)
+	{
+		static thread_local std::vector<VkDependencyInfoKHR> infos;
+		infos.clear();
+		infos.reserve(events.size());
+		for (const auto event : events)
+		{
+			infos.push_back(VkDependencyInfoKHR{ .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR,
+				.memoryBarrierCount = u32(event->m_Memory.size()),
+				.pMemoryBarriers = event->m_Memory.data(),
+				.bufferMemoryBarrierCount = u32(event->m_Buffers.size()),
+				.pBufferMemoryBarriers = event->m_Buffers.data(),
+				.imageMemoryBarrierCount = u32(event->m_Images.size()),
+				.pImageMemoryBarriers = event->m_Images.data() });
+		}
+
+		vkCmdWaitEvents2KHR(m_Buffer, u32(handles.size()), handles.data(), infos.data());
+		return;
+	}
+
+	// The legacy wait takes the stages of all events at once, which have to match what they were signalled with
+	static thread_local std::vector<VkMemoryBarrier> memoryBarriers;
+	static thread_local std::vector<VkBufferMemoryBarrier> bufferBarriers;
+	static thread_local std::vector<VkImageMemoryBarrier> imageBarriers;
+
+	memoryBarriers.clear();
+	bufferBarriers.clear();
+	imageBarriers.clear();
+
+	VkPipelineStageFlags2KHR source = 0;
+	VkPipelineStageFlags2KHR destination = 0;
+	for (const auto event : events)
+	{
+		for (const auto& mem : event->m_Memory)
+		{
+			source |= mem.srcStageMask;
+			destination |= mem.dstStageMask;
+			memoryBarriers.push_back(VkMemoryBarrier{ .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+				.srcAccessMask = VkAccessFlags(mem.srcAccessMask),
+				.dstAccessMask = VkAccessFlags(mem.dstAccessMask) });
+		}
+		for (const auto& buf : event->m_Buffers)
+		{
+			source |= buf.srcStageMask;
+			destination |= buf.dstStageMask;
+			bufferBarriers.push_back(VkBufferMemoryBarrier{ .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+				.srcAccessMask = VkAccessFlags(buf.srcAccessMask),
+				.dstAccessMask = VkAccessFlags(buf.dstAccessMask),
+				.srcQueueFamilyIndex = buf.srcQueueFamilyIndex,
+				.dstQueueFamilyIndex = buf.dstQueueFamilyIndex,
+				.buffer = buf.buffer,
+				.offset = buf.offset,
+				.size = buf.size });
+		}
+		for (const auto& img : event->m_Images)
+		{
+			source |= img.srcStageMask;
+			destination |= img.dstStageMask;
+			imageBarriers.push_back(VkImageMemoryBarrier{ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+				.srcAccessMask = VkAccessFlags(img.srcAccessMask),
+				.dstAccessMask = VkAccessFlags(img.dstAccessMask),
+				.oldLayout = img.oldLayout,
+				.newLayout = img.newLayout,
+				.srcQueueFamilyIndex = img.srcQueueFamilyIndex,
+				.dstQueueFamilyIndex = img.dstQueueFamilyIndex,
+				.image = img.image,
+				.subresourceRange = img.subresourceRange });
+		}
+	}
+
+	vkCmdWaitEvents(m_Buffer, u32(handles.size()), handles.data(),
+		GetLegacyStages(source, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT),
+		GetLegacyStages(destination, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT), u32(memoryBarriers.size()),
+		memoryBarriers.data(), u32(bufferBarriers.size()), bufferBarriers.data(), u32(imageBarriers.size()),
+		imageBarriers.data());
+}
+
+void CommandBuffer::ResetEvent(GpuEvent& event, VkPipelineStageFlags2KHR stage)
+{
+	FlushBarriers();
+
+	if (Instance::Features().Synchronization2)
+	{
+		vkCmdResetEvent2KHR(m_Buffer, event.GetHandle(), stage);
+	}
+	else
+	{
+		vkCmdResetEvent(m_Buffer, event.GetHandle(), GetLegacyStages(stage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT));
+	}
+}
+
+void CommandBuffer::ResetQueries(const QueryPool& pool, u32 first, u32 count)
+{
+	vkCmdResetQueryPool(m_Buffer, pool.GetHandle(), first, count);
+}
+
+void CommandBuffer::WriteTimestamp(VkPipelineStageFlagBits stage, const QueryPool& pool, u32 index)
+{
+	FlushBarriers();
+	vkCmdWriteTimestamp(m_Buffer, stage, pool.GetHandle(), index);
+}
+
+void CommandBuffer::BeginQuery(const QueryPool& pool, u32 index, VkQueryControlFlags flags)
+{
+	FlushBarriers();
+	vkCmdBeginQuery(m_Buffer, pool.GetHandle(), index, flags);
+}
+
+void CommandBuffer::EndQuery(const QueryPool& pool, u32 index)
+{
+	FlushBarriers();
+	vkCmdEndQuery(m_Buffer, pool.GetHandle(), index);
+}
+
 void CommandBuffer::Draw(u32 vertexCount, u32 instanceCount, u32 firstVertex, u32 firstInstance)
 {
+	FlushBarriers();
 	vkCmdDraw(m_Buffer, vertexCount, instanceCount, firstVertex, firstInstance);
+	CountDraw(u64(vertexCount) * instanceCount);
 }
 
 void CommandBuffer::DrawIndexed(u32 indexCount, u32 instanceCount, u32 firstIndex, i32 vertexOffset, u32 firstInstance)
 {
+	FlushBarriers();
 	vkCmdDrawIndexed(m_Buffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+	CountDraw(u64(indexCount) * instanceCount);
 }
 
-CommandBuffer::~CommandBuffer()
+void CommandBuffer::DrawIndexedIndirect(const Buffer& buffer, u64 offset, u32 drawCount, u32 stride)
 {
-	if (m_Pool)
+	FlushBarriers();
+	if (Instance::Features().MultiDrawIndirect)
 	{
-		vkFreeCommandBuffers(Instance::Device(), m_Pool, 1, &m_Buffer);
+		vkCmdDrawIndexedIndirect(m_Buffer, buffer.GetHandle(), offset, drawCount, stride);
+	}
+	else
+	{
+		for (u32 i = 0; i < drawCount; i++)
+		{
+			vkCmdDrawIndexedIndirect(m_Buffer, buffer.GetHandle(), offset + u64(i) * stride, 1, stride);
+		}
+	}
+
+	// Only the GPU knows how much each draw renders, so nothing but the draws themselves is counted
+	m_Stats.Draws += drawCount;
+}
+
+void CommandBuffer::Dispatch(u32 x, u32 y, u32 z)
+{
+	FlushBarriers();
+	vkCmdDispatch(m_Buffer, x, y, z);
+	m_Stats.Dispatches++;
+}
+
+void CommandBuffer::CountDraw(u64 vertices)
+{
+	m_Stats.Draws++;
+	m_Stats.Vertices += vertices;
+
+	// Per instance would be exact for strips, but this is only for statistics
+	switch (m_Topology)
+	{
+	case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST: m_Stats.Triangles += vertices / 3; break;
+	case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP:
+	case VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN: m_Stats.Triangles += vertices > 2 ? vertices - 2 : 0; break;
+	default: break;
 	}
 }
 
+CommandBuffer::~CommandBuffer() { Destroy(); }
+
 CommandBuffer::CommandBuffer(CommandBuffer&& other)
 {
 	m_Buffer = other.m_Buffer;
 	other.m_Buffer = VK_NULL_HANDLE;
 	m_Pool = other.m_Pool;
+	m_PendingMemory = std::move(other.m_PendingMemory);
+	m_PendingBuffers = std::move(other.m_PendingBuffers);
+	m_PendingImages = std::move(other.m_PendingImages);
+	m_Stats = other.m_Stats;
+	m_Topology = other.m_Topology;
 }
 
 CommandBuffer& CommandBuffer::operator=(CommandBuffer&& other)
 {
-	this->~CommandBuffer();
+	Destroy();
 
 	m_Buffer = other.m_Buffer;
 	other.m_Buffer = VK_NULL_HANDLE;
 	m_Pool = other.m_Pool;
+	m_PendingMemory = std::move(other.m_PendingMemory);
+	m_PendingBuffers = std::move(other.m_PendingBuffers);
+	m_PendingImages = std::move(other.m_PendingImages);
+	m_Stats = other.m_Stats;
+	m_Topology = other.m_Topology;
 
 	return *this;
 }
 
+void CommandBuffer::Destroy()
+{
+	if (m_Pool)
+	{
+		vkFreeCommandBuffers(Instance::Device(), m_Pool, 1, &m_Buffer);
+	}
+}
+
 CommandPool::CommandPool(VkCommandPoolCreateFlags flags)
 {
 	VkCommandPoolCreateInfo info{ .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
@@ -189,7 +780,7 @@ CommandPool::CommandPool(VkCommandPoolCreateFlags flags)
 
 CommandBuffer CommandPool::Allocate(VkCommandBufferLevel level) { return CommandBuffer(m_Pool, level); }
 
-CommandPool::~CommandPool() { vkDestroyCommandPool(Instance::Device(), m_Pool, nullptr); }
+CommandPool::~CommandPool() { Destroy(); }
 
 CommandPool::CommandPool(CommandPool&& other)
 {
@@ -199,10 +790,12 @@ CommandPool::CommandPool(CommandPool&& other)
 
 CommandPool& CommandPool::operator=(CommandPool&& other)
 {
-	this->~CommandPool();
+	Destroy();
 
 	m_Pool = other.m_Pool;
 	other.m_Pool = VK_NULL_HANDLE;
 
 	return *this;
 }
+
+void CommandPool::Destroy() { vkDestroyCommandPool(Instance::Device(), m_Pool, nullptr); }
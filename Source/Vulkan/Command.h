@@ -5,12 +5,17 @@
 class Buffer;
 class DescriptorSet;
 class Framebuffer;
+class GpuEvent;
 class Image;
+class ImageView;
 class Pipeline;
 class PipelineLayout;
+class QueryPool;
 class RenderPass;
 class Viewport;
 
+struct BufferSlice;
+
 struct InheritanceInfo
 {
 	RenderPass* Pass;
@@ -18,19 +23,32 @@ struct InheritanceInfo
 	Framebuffer* Framebuf;
 };
 
+struct RenderingAttachment
+{
+	const ImageView& View;
+	VkImageLayout Layout;
+	VkAttachmentLoadOp Load = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	VkAttachmentStoreOp Store = VK_ATTACHMENT_STORE_OP_STORE;
+	VkClearValue Clear{};
+};
+
 struct MemoryBarrier
 {
 	VkAccessFlags Source;
 	VkAccessFlags Destination;
+	VkPipelineStageFlags2KHR SourceStage = 0;
+	VkPipelineStageFlags2KHR DestinationStage = 0;
 };
 
 struct BufferBarrier
 {
 	VkAccessFlags Source;
 	VkAccessFlags Destination;
-	const Buffer& Buf;
+	VkBuffer Buf;
 	u64 Offset;
 	u64 Size;
+	VkPipelineStageFlags2KHR SourceStage = 0;
+	VkPipelineStageFlags2KHR DestinationStage = 0;
 };
 
 struct ImageBarrier
@@ -39,8 +57,25 @@ struct ImageBarrier
 	VkAccessFlags Destination;
 	VkImageLayout From;
 	VkImageLayout To;
-	const Image& Img;
+	VkImage Img;
 	VkImageSubresourceRange Range;
+	VkPipelineStageFlags2KHR SourceStage = 0;
+	VkPipelineStageFlags2KHR DestinationStage = 0;
+};
+
+// What a command buffer recorded since it began. Barriers are counted one by one, not by the commands they are in.
+struct CommandStats
+{
+	u32 Draws = 0;
+	u32 Dispatches = 0;
+	u64 Vertices = 0;
+	u64 Triangles = 0;
+	u32 PipelineBinds = 0;
+	u32 DescriptorBinds = 0;
+	u32 Barriers = 0;
+	u32 Copies = 0;
+
+	CommandStats& operator+=(const CommandStats& other);
 };
 
 class CommandBuffer
@@ -56,6 +91,7 @@ public:
 	CommandBuffer& operator=(CommandBuffer&& other);
 
 	VkCommandBuffer GetHandle() const { return m_Buffer; }
+	const CommandStats& GetStats() const { return m_Stats; }
 
 	void Begin(VkCommandBufferUsageFlags flags = 0, std::optional<InheritanceInfo> info = std::nullopt);
 	void End();
@@ -64,29 +100,94 @@ public:
 		std::span<VkClearValue> clearValues, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
 	void EndRenderPass();
 
+	void BeginRendering(VkRect2D area, std::span<RenderingAttachment> color,
+		std::optional<RenderingAttachment> depth = std::nullopt,
+		std::optional<RenderingAttachment> stencil = std::nullopt, u32 layers = 1);
+	void EndRendering();
+
 	void BindPipeline(const Pipeline& pipeline);
 	void BindViewport(const Viewport& viewport);
+
+	// Extended dynamic state, the pipeline must have been created with the matching VkDynamicState
+	void SetCullMode(VkCullModeFlags mode);
+	void SetFrontFace(VkFrontFace face);
+	void SetPrimitiveTopology(VkPrimitiveTopology topology);
+	void SetDepthTest(VkBool32 enable, VkBool32 write, VkCompareOp compareOp);
+	void SetDepthBoundsTest(VkBool32 enable);
+	void SetStencilTest(VkBool32 enable);
+	void SetStencilOp(VkStencilFaceFlags faces, VkStencilOp fail, VkStencilOp pass, VkStencilOp depthFail,
+		VkCompareOp compareOp);
+
 	void BindVertexBuffer(const Buffer& buffer, u64 offset);
 	void BindIndexBuffer(const Buffer& buffer, u64 offset, VkIndexType type);
+	void BindVertexBuffer(const BufferSlice& slice);
+	void BindIndexBuffer(const BufferSlice& slice, VkIndexType type);
 	void BindDescriptorSet(const PipelineLayout& layout, u32 index, const DescriptorSet& set,
 		std::optional<u32> dynamicOffset = std::nullopt);
+	void PushConstants(
+		const PipelineLayout& layout, VkShaderStageFlags stages, u32 offset, u32 size, const void* data);
 
 	void CopyBuffer(const Buffer& from, const Buffer& to, std::span<VkBufferCopy> regions);
 	void CopyBufferToImage(
 		const Buffer& from, const Image& to, VkImageLayout currLayout, std::span<VkBufferImageCopy> regions);
 	void PipelineBarrier(VkPipelineStageFlags source, VkPipelineStageFlags destination, VkDependencyFlags dependency,
 		std::span<MemoryBarrier> memory, std::span<BufferBarrier> buffers, std::span<ImageBarrier> images);
+	// Uses vkCmdPipelineBarrier2 if Synchronization2 is supported, otherwise the stages of all barriers are combined
+	void PipelineBarrier(VkDependencyFlags dependency, std::span<MemoryBarrier> memory,
+		std::span<BufferBarrier> buffers, std::span<ImageBarrier> images);
+
+	// Barriers from the tracked state of the resource, stages are derived from the access if not given. Only the
+	// barriers actually needed are recorded, merged into a single barrier right before the next command.
+	void Transition(Image& image, VkImageLayout layout, VkAccessFlags access, VkPipelineStageFlags stages = 0,
+		std::optional<VkImageSubresourceRange> range = std::nullopt);
+	void Transition(Buffer& buffer, VkAccessFlags access, VkPipelineStageFlags stages = 0);
+	void FlushBarriers();
+
+	// Split barrier using the stages of each barrier. The signal stores the barriers in the event to be recorded again
+	// by the wait, so an event can't be signalled again until it has been waited on. Tracked state isn't updated.
+	void SignalEvent(GpuEvent& event, std::span<MemoryBarrier> memory, std::span<BufferBarrier> buffers,
+		std::span<ImageBarrier> images);
+	void WaitEvents(std::span<GpuEvent*> events);
+	void ResetEvent(GpuEvent& event, VkPipelineStageFlags2KHR stage);
+
+	// Queries have to be reset before they are written again, outside of a render pass
+	void ResetQueries(const QueryPool& pool, u32 first, u32 count);
+	void WriteTimestamp(VkPipelineStageFlagBits stage, const QueryPool& pool, u32 index);
+	void BeginQuery(const QueryPool& pool, u32 index, VkQueryControlFlags flags = 0);
+	void EndQuery(const QueryPool& pool, u32 index);
 
 	void Draw(u32 vertexCount, u32 instanceCount, u32 firstVertex, u32 firstInstance);
 	void DrawIndexed(u32 indexCount, u32 instanceCount, u32 firstIndex, i32 vertexOffset, u32 firstInstance);
+	// Reads drawCount VkDrawIndexedIndirectCommands, issued one by one if the device can't take them all at once
+	void DrawIndexedIndirect(const Buffer& buffer, u64 offset, u32 drawCount, u32 stride);
+	void Dispatch(u32 x, u32 y, u32 z);
 
 private:
 	friend class CommandPool;
 
+	void Destroy();
+
 	CommandBuffer(VkCommandPool pool, VkCommandBufferLevel level);
 
+	void RecordBarriers(VkDependencyFlags dependency, std::span<MemoryBarrier> memory,
+		std::span<BufferBarrier> buffers, std::span<ImageBarrier> images);
+	void RecordLegacyBarriers(VkPipelineStageFlags source, VkPipelineStageFlags destination,
+		VkDependencyFlags dependency, std::span<MemoryBarrier> memory, std::span<BufferBarrier> buffers,
+		std::span<ImageBarrier> images);
+
+	void CountDraw(u64 vertices);
+
 	VkCommandBuffer m_Buffer = VK_NULL_HANDLE;
 	VkCommandPool m_Pool = VK_NULL_HANDLE;
+
+	CommandStats m_Stats;
+	// Triangles are counted with the topology of the bound pipeline
+	VkPrimitiveTopology m_Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+	// Recorded by the next FlushBarriers, so they only hold handles and never the resources themselves
+	std::vector<MemoryBarrier> m_PendingMemory;
+	std::vector<BufferBarrier> m_PendingBuffers;
+	std::vector<ImageBarrier> m_PendingImages;
 };
 
 class CommandPool
@@ -106,5 +207,7 @@ public:
 	CommandBuffer Allocate(VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 
 private:
+	void Destroy();
+
 	VkCommandPool m_Pool = VK_NULL_HANDLE;
 };
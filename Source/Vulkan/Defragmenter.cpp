@@ -0,0 +1,151 @@
+#include "PCH.h"
+
+#include "Defragmenter.h"
+
+// How often fragmentation is checked while idle, and how much of it starts a pass
+constexpr auto CheckInterval = std::chrono::seconds(10);
+constexpr f32 StartFragmentation = 0.25f;
+
+Defragmenter::Defragmenter(u64 maxBytesPerStep)
+	: m_MaxBytesPerStep(maxBytesPerStep), m_Pool(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT),
+	  m_LastCheck(std::chrono::steady_clock::now())
+{
+	m_Commands = m_Pool.Allocate();
+}
+
+void Defragmenter::Register(Buffer& buffer, RelocationCallback callback)
+{
+	m_Entries.push_back(Entry{ .Target = &buffer, .Callback = std::move(callback) });
+	m_Exhausted = false;
+}
+
+void Defragmenter::Unregister(const Buffer& buffer)
+{
+	std::erase_if(m_Entries, [&](const Entry& entry) { return entry.Target == &buffer; });
+	m_Exhausted = false;
+}
+
+void Defragmenter::Step()
+{
+	if (m_Entries.empty())
+	{
+		return;
+	}
+
+	if (!m_Active)
+	{
+		auto now = std::chrono::steady_clock::now();
+		if (now - m_LastCheck < CheckInterval)
+		{
+			return;
+		}
+
+		m_LastCheck = now;
+		FragmentationStats last = m_Stats;
+		UpdateStats();
+		// Another pass couldn't move anything either while the memory looks the same
+		if (m_Exhausted && m_Stats.UsedBytes == last.UsedBytes && m_Stats.BlockCount == last.BlockCount)
+		{
+			return;
+		}
+		m_Exhausted = false;
+
+		// Not worth it if there isn't even a step's worth of memory to win back
+		if (m_Stats.Fragmentation < StartFragmentation || m_Stats.UnusedBytes < m_MaxBytesPerStep)
+		{
+			return;
+		}
+
+		DEBUG("Defragmenting GPU memory, {:.0f}% fragmented over {} blocks", m_Stats.Fragmentation * 100.f,
+			m_Stats.BlockCount);
+		m_Active = true;
+		m_BytesMoved = 0;
+		m_BytesFreed = 0;
+		m_BlocksFreed = 0;
+	}
+
+	m_Allocations.clear();
+	for (const Entry& entry : m_Entries)
+	{
+		m_Allocations.push_back(entry.Target->GetMemory());
+	}
+	m_Changed.assign(m_Allocations.size(), VK_FALSE);
+
+	// Host visible memory is moved by the CPU right away, the rest with copies recorded into the command buffer
+	VmaDefragmentationInfo2 info{ .allocationCount = u32(m_Allocations.size()),
+		.pAllocations = m_Allocations.data(),
+		.pAllocationsChanged = m_Changed.data(),
+		.maxCpuBytesToMove = m_MaxBytesPerStep,
+		.maxCpuAllocationsToMove = UINT32_MAX,
+		.maxGpuBytesToMove = m_MaxBytesPerStep,
+		.maxGpuAllocationsToMove = UINT32_MAX,
+		.commandBuffer = m_Commands.GetHandle() };
+
+	m_Commands.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	MemoryBarrier before[] = { { .Source = VK_ACCESS_MEMORY_WRITE_BIT,
+		.Destination = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT } };
+	m_Commands.PipelineBarrier(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, before, {}, {});
+
+	VmaDefragmentationStats stats{};
+	VmaDefragmentationContext context = VK_NULL_HANDLE;
+	VkResult result = vmaDefragmentationBegin(Instance::Allocator(), &info, &stats, &context);
+
+	MemoryBarrier after[] = { { .Source = VK_ACCESS_TRANSFER_WRITE_BIT,
+		.Destination = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT } };
+	m_Commands.PipelineBarrier(VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, after, {}, {});
+	m_Commands.End();
+
+	// Not ready means there are copies to run before the old memory can be freed
+	if (result == VK_NOT_READY)
+	{
+		CommandBuffer* buffers[] = { &m_Commands };
+		Instance::Submit(buffers, {}, {}, &m_Fence);
+		m_Fence.WaitOn();
+		m_Fence.Reset();
+	}
+	else
+	{
+		VkCall(result);
+	}
+	VkCall(vmaDefragmentationEnd(Instance::Allocator(), context));
+
+	for (u64 i = 0; i < m_Entries.size(); i++)
+	{
+		if (m_Changed[i])
+		{
+			m_Entries[i].Target->Recreate();
+			if (m_Entries[i].Callback)
+			{
+				m_Entries[i].Callback(*m_Entries[i].Target);
+			}
+		}
+	}
+
+	m_BytesMoved += stats.bytesMoved;
+	m_BytesFreed += stats.bytesFreed;
+	m_BlocksFreed += stats.deviceMemoryBlocksFreed;
+
+	// Done once a step can't move anything anymore
+	if (stats.allocationsMoved == 0)
+	{
+		m_Active = false;
+		m_Exhausted = m_BytesMoved == 0;
+		UpdateStats();
+		DEBUG("Defragmentation moved {} KB and freed {} blocks ({} KB), now {:.0f}% fragmented", m_BytesMoved >> 10,
+			m_BlocksFreed, m_BytesFreed >> 10, m_Stats.Fragmentation * 100.f);
+	}
+}
+
+void Defragmenter::UpdateStats()
+{
+	VmaStats stats;
+	vmaCalculateStats(Instance::Allocator(), &stats);
+
+	const VmaStatInfo& total = stats.total;
+	m_Stats = FragmentationStats{ .BlockCount = total.blockCount,
+		.UsedBytes = total.usedBytes,
+		.UnusedBytes = total.unusedBytes,
+		.LargestUnusedRange = total.unusedRangeSizeMax,
+		.Fragmentation =
+			total.unusedBytes ? 1.f - f32(f64(total.unusedRangeSizeMax) / f64(total.unusedBytes)) : 0.f };
+}
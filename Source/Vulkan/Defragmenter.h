@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Buffer.h"
+#include "Command.h"
+#include "Sync.h"
+
+struct FragmentationStats
+{
+	u32 BlockCount = 0;
+	u64 UsedBytes = 0;
+	u64 UnusedBytes = 0;
+	u64 LargestUnusedRange = 0;
+	// Zero when all unused memory is in one range, approaching one the more it is split up
+	f32 Fragmentation = 0.f;
+};
+
+// Compacts VMA's memory blocks by moving buffer allocations a few MB at a time, so long sessions can free blocks
+// again. Images aren't moved, as VMA 2.3 can only move allocations whose contents can be copied as plain bytes.
+class Defragmenter
+{
+public:
+	// Called after the buffer got a new handle, to update whatever referred to the old one
+	using RelocationCallback = std::function<void(Buffer& buffer)>;
+
+	Defragmenter() = default;
+	Defragmenter(u64 maxBytesPerStep);
+
+	Defragmenter(const Defragmenter& other) = delete;
+	Defragmenter& operator=(const Defragmenter& other) = delete;
+
+	Defragmenter(Defragmenter&& other) = default;
+	Defragmenter& operator=(Defragmenter&& other) = default;
+
+	// The buffer must stay at the same address until it is unregistered
+	void Register(Buffer& buffer, RelocationCallback callback = nullptr);
+	void Unregister(const Buffer& buffer);
+
+	// Moves at most the step size if memory is fragmented enough, and waits for the moves to finish. Only call while
+	// the GPU isn't using any registered buffer, e.g. right after waiting on the last frame. After a pass that moved
+	// nothing, the next one only starts once the registered buffers or the memory usage changed.
+	void Step();
+
+	// As of the last time defragmentation was considered or finished
+	const FragmentationStats& GetStats() const { return m_Stats; }
+
+private:
+	void UpdateStats();
+
+	struct Entry
+	{
+		Buffer* Target;
+		RelocationCallback Callback;
+	};
+
+	u64 m_MaxBytesPerStep = 0;
+	std::vector<Entry> m_Entries;
+	// Indexed like the entries, only kept to not allocate every step
+	std::vector<VmaAllocation> m_Allocations;
+	std::vector<VkBool32> m_Changed;
+
+	CommandPool m_Pool;
+	CommandBuffer m_Commands;
+	Fence m_Fence;
+
+	bool m_Active = false;
+	// Fragmentation that's left is in memory that can't be moved, like images and render graph blocks
+	bool m_Exhausted = false;
+	std::chrono::steady_clock::time_point m_LastCheck;
+	FragmentationStats m_Stats;
+
+	// Over the current pass through all buffers
+	u64 m_BytesMoved = 0;
+	u64 m_BytesFreed = 0;
+	u32 m_BlocksFreed = 0;
+};
@@ -165,3 +165,76 @@ DynamicState& DynamicState::operator=(DynamicState&& other)
 
 	return *this;
 }
+
+bool DynamicState::Contains(VkDynamicState state) const
+{
+	return std::find(m_States.begin(), m_States.end(), state) != m_States.end();
+}
+
+bool DynamicState::UsesExtendedState() const
+{
+	for (auto state : m_States)
+	{
+		switch (state)
+		{
+		case VK_DYNAMIC_STATE_CULL_MODE_EXT:
+		case VK_DYNAMIC_STATE_FRONT_FACE_EXT:
+		case VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT:
+		case VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT_EXT:
+		case VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT_EXT:
+		case VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE_EXT:
+		case VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT:
+		case VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT:
+		case VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT:
+		case VK_DYNAMIC_STATE_DEPTH_BOUNDS_TEST_ENABLE_EXT:
+		case VK_DYNAMIC_STATE_STENCIL_TEST_ENABLE_EXT:
+		case VK_DYNAMIC_STATE_STENCIL_OP_EXT:
+			return true;
+		default:
+			break;
+		}
+	}
+
+	return false;
+}
+
+RenderingFormats::RenderingFormats(std::initializer_list<VkFormat> color, VkFormat depth, VkFormat stencil)
+{
+	m_Color = color;
+	m_Info.colorAttachmentCount = u32(m_Color.size());
+	m_Info.pColorAttachmentFormats = m_Color.data();
+	m_Info.depthAttachmentFormat = depth;
+	m_Info.stencilAttachmentFormat = stencil;
+}
+
+RenderingFormats::RenderingFormats(const RenderingFormats& other)
+{
+	m_Color = other.m_Color;
+	m_Info = other.m_Info;
+	m_Info.pColorAttachmentFormats = m_Color.data();
+}
+
+RenderingFormats& RenderingFormats::operator=(const RenderingFormats& other)
+{
+	m_Color = other.m_Color;
+	m_Info = other.m_Info;
+	m_Info.pColorAttachmentFormats = m_Color.data();
+
+	return *this;
+}
+
+RenderingFormats::RenderingFormats(RenderingFormats&& other)
+{
+	m_Color = std::move(other.m_Color);
+	m_Info = other.m_Info;
+	m_Info.pColorAttachmentFormats = m_Color.data();
+}
+
+RenderingFormats& RenderingFormats::operator=(RenderingFormats&& other)
+{
+	m_Color = std::move(other.m_Color);
+	m_Info = other.m_Info;
+	m_Info.pColorAttachmentFormats = m_Color.data();
+
+	return *this;
+}
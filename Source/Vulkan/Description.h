@@ -95,9 +95,32 @@ public:
 	DynamicState(DynamicState&& other);
 	DynamicState& operator=(DynamicState&& other);
 
+	bool Contains(VkDynamicState state) const;
+	bool UsesExtendedState() const;
+
 	const VkPipelineDynamicStateCreateInfo& GetInfo() const { return m_Info; }
 
 private:
 	VkPipelineDynamicStateCreateInfo m_Info{ .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
 	std::vector<VkDynamicState> m_States;
 };
+
+class RenderingFormats
+{
+public:
+	RenderingFormats() = default;
+	RenderingFormats(std::initializer_list<VkFormat> color, VkFormat depth = VK_FORMAT_UNDEFINED,
+		VkFormat stencil = VK_FORMAT_UNDEFINED);
+
+	RenderingFormats(const RenderingFormats& other);
+	RenderingFormats& operator=(const RenderingFormats& other);
+
+	RenderingFormats(RenderingFormats&& other);
+	RenderingFormats& operator=(RenderingFormats&& other);
+
+	const VkPipelineRenderingCreateInfoKHR& GetInfo() const { return m_Info; }
+
+private:
+	VkPipelineRenderingCreateInfoKHR m_Info{ .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR };
+	std::vector<VkFormat> m_Color;
+};
@@ -17,13 +17,7 @@ DescriptorSet::DescriptorSet(VkDescriptorPool pool, VkDescriptorSetLayout layout
 	VkCall(vkAllocateDescriptorSets(Instance::Device(), &info, &m_Set));
 }
 
-DescriptorSet::~DescriptorSet()
-{
-	if (m_Pool)
-	{
-		vkFreeDescriptorSets(Instance::Device(), m_Pool, 1, &m_Set);
-	}
-}
+DescriptorSet::~DescriptorSet() { Destroy(); }
 
 DescriptorSet::DescriptorSet(DescriptorSet&& other)
 {
@@ -34,7 +28,7 @@ DescriptorSet::DescriptorSet(DescriptorSet&& other)
 
 DescriptorSet& DescriptorSet::operator=(DescriptorSet&& other)
 {
-	this->~DescriptorSet();
+	Destroy();
 
 	m_Set = other.m_Set;
 	other.m_Set = VK_NULL_HANDLE;
@@ -43,6 +37,14 @@ DescriptorSet& DescriptorSet::operator=(DescriptorSet&& other)
 	return *this;
 }
 
+void DescriptorSet::Destroy()
+{
+	if (m_Pool)
+	{
+		vkFreeDescriptorSets(Instance::Device(), m_Pool, 1, &m_Set);
+	}
+}
+
 void DescriptorSet::Update(u32 binding, u32 arrayElement, VkDescriptorType type, std::span<BufferUpdate> buffers)
 {
 	static thread_local std::vector<VkDescriptorBufferInfo> bInfos;
@@ -101,7 +103,7 @@ DescriptorSet DescriptorPool::Allocate(const PipelineLayout& layout, u32 layoutI
 	return DescriptorSet(m_Pool, layout.GetSetLayout(layoutIndex));
 }
 
-DescriptorPool::~DescriptorPool() { vkDestroyDescriptorPool(Instance::Device(), m_Pool, nullptr); }
+DescriptorPool::~DescriptorPool() { Destroy(); }
 
 DescriptorPool::DescriptorPool(DescriptorPool&& other)
 {
@@ -111,10 +113,12 @@ DescriptorPool::DescriptorPool(DescriptorPool&& other)
 
 DescriptorPool& DescriptorPool::operator=(DescriptorPool&& other)
 {
-	this->~DescriptorPool();
+	Destroy();
 
 	m_Pool = other.m_Pool;
 	other.m_Pool = VK_NULL_HANDLE;
 
 	return *this;
 }
+
+void DescriptorPool::Destroy() { vkDestroyDescriptorPool(Instance::Device(), m_Pool, nullptr); }
@@ -41,6 +41,8 @@ public:
 private:
 	friend class DescriptorPool;
 
+	void Destroy();
+
 	DescriptorSet(VkDescriptorPool pool, VkDescriptorSetLayout layout);
 
 	VkDescriptorSet m_Set = VK_NULL_HANDLE;
@@ -63,5 +65,7 @@ public:
 	DescriptorSet Allocate(const PipelineLayout& layout, u32 layoutIndex);
 
 private:
+	void Destroy();
+
 	VkDescriptorPool m_Pool = VK_NULL_HANDLE;
 };
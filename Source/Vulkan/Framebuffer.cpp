@@ -21,7 +21,7 @@ Framebuffer::Framebuffer(const RenderPass& renderPass, glm::u32vec2 size, u32 la
 	VkCall(vkCreateFramebuffer(Instance::Device(), &info, nullptr, &m_Framebuffer));
 }
 
-Framebuffer::~Framebuffer() { vkDestroyFramebuffer(Instance::Device(), m_Framebuffer, nullptr); }
+Framebuffer::~Framebuffer() { Destroy(); }
 
 Framebuffer::Framebuffer(Framebuffer&& other)
 {
@@ -31,9 +31,11 @@ Framebuffer::Framebuffer(Framebuffer&& other)
 
 Framebuffer& Framebuffer::operator=(Framebuffer&& other)
 {
-	this->~Framebuffer();
+	Destroy();
 	m_Framebuffer = other.m_Framebuffer;
 	other.m_Framebuffer = VK_NULL_HANDLE;
 
 	return *this;
 }
+
+void Framebuffer::Destroy() { vkDestroyFramebuffer(Instance::Device(), m_Framebuffer, nullptr); }
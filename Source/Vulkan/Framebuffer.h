@@ -21,5 +21,7 @@ public:
 	VkFramebuffer GetHandle() const { return m_Framebuffer; }
 
 private:
+	void Destroy();
+
 	VkFramebuffer m_Framebuffer = VK_NULL_HANDLE;
 };
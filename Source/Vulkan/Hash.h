@@ -0,0 +1,23 @@
+#pragma once
+
+constexpr u64 HashSeed = 14695981039346656037ull;
+
+// FNV-1a
+inline u64 HashBytes(const void* data, u64 size, u64 hash = HashSeed)
+{
+	auto bytes = reinterpret_cast<const u8*>(data);
+	for (u64 i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+template<typename T>
+u64 HashValue(u64 hash, const T& value)
+{
+	static_assert(std::is_scalar_v<T>, "Only scalars can be hashed by value, padding would be hashed otherwise");
+	return HashBytes(&value, sizeof(T), hash);
+}
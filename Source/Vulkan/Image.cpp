@@ -2,6 +2,25 @@
 
 #include "Image.h"
 
+static VkImageAspectFlags GetAspect(VkFormat format)
+{
+	switch (format)
+	{
+	case VK_FORMAT_D16_UNORM:
+	case VK_FORMAT_X8_D24_UNORM_PACK32:
+	case VK_FORMAT_D32_SFLOAT:
+		return VK_IMAGE_ASPECT_DEPTH_BIT;
+	case VK_FORMAT_S8_UINT:
+		return VK_IMAGE_ASPECT_STENCIL_BIT;
+	case VK_FORMAT_D16_UNORM_S8_UINT:
+	case VK_FORMAT_D24_UNORM_S8_UINT:
+	case VK_FORMAT_D32_SFLOAT_S8_UINT:
+		return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+	default:
+		return VK_IMAGE_ASPECT_COLOR_BIT;
+	}
+}
+
 ImageView::ImageView(VkImage vkImage, VkFormat format, VkImageViewType viewType, VkComponentMapping mapping,
 	VkImageSubresourceRange range, VkImageViewCreateFlags flags)
 {
@@ -32,7 +51,7 @@ ImageView::ImageView(const Image& image, VkFormat format, VkImageViewType viewTy
 	VkCall(vkCreateImageView(Instance::Device(), &info, nullptr, &m_View));
 }
 
-ImageView::~ImageView() { vkDestroyImageView(Instance::Device(), m_View, nullptr); }
+ImageView::~ImageView() { Destroy(); }
 
 ImageView::ImageView(ImageView&& other)
 {
@@ -42,7 +61,7 @@ ImageView::ImageView(ImageView&& other)
 
 ImageView& ImageView::operator=(ImageView&& other)
 {
-	this->~ImageView();
+	Destroy();
 
 	m_View = other.m_View;
 	other.m_View = VK_NULL_HANDLE;
@@ -50,9 +69,43 @@ ImageView& ImageView::operator=(ImageView&& other)
 	return *this;
 }
 
+void ImageView::Destroy() { vkDestroyImageView(Instance::Device(), m_View, nullptr); }
+
 Image::Image(VkImageType type, VkFormat format, glm::u32vec3 size, u32 mipLevels, u32 layers,
 	VkSampleCountFlagBits samples, VkImageUsageFlags usage, VkImageLayout layout, VmaMemoryUsage memUsage,
-	VkImageCreateFlags flags)
+	MemoryTag tag, VkImageCreateFlags flags)
+	: m_Tag(tag)
+{
+	VkResult result = Allocate(type, format, size, mipLevels, layers, samples, usage, layout, memUsage, 0, flags);
+	if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY || result == VK_ERROR_OUT_OF_HOST_MEMORY)
+	{
+		Memory::OutOfMemory(result, tag, fmt::format("a {}x{}x{} image", size.x, size.y, size.z));
+	}
+	VkCall(result);
+}
+
+std::optional<Image> Image::TryCreate(VkImageType type, VkFormat format, glm::u32vec3 size, u32 mipLevels, u32 layers,
+	VkSampleCountFlagBits samples, VkImageUsageFlags usage, VkImageLayout layout, VmaMemoryUsage memUsage,
+	MemoryTag tag, VkImageCreateFlags flags)
+{
+	Image image;
+	image.m_Tag = tag;
+	VkResult result = image.Allocate(
+		type, format, size, mipLevels, layers, samples, usage, layout, memUsage, Memory::GetBudgetFlags(), flags);
+	if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY || result == VK_ERROR_OUT_OF_HOST_MEMORY)
+	{
+		DEBUG("No memory left within the budget for a {}x{}x{} {} image", size.x, size.y, size.z,
+			Memory::GetTagName(tag));
+		return std::nullopt;
+	}
+	VkCall(result);
+
+	return image;
+}
+
+VkResult Image::Allocate(VkImageType type, VkFormat format, glm::u32vec3 size, u32 mipLevels, u32 layers,
+	VkSampleCountFlagBits samples, VkImageUsageFlags usage, VkImageLayout layout, VmaMemoryUsage memUsage,
+	VmaAllocationCreateFlags allocFlags, VkImageCreateFlags flags)
 {
 	u32 index = Instance::GraphicsIndex();
 
@@ -71,12 +124,55 @@ Image::Image(VkImageType type, VkFormat format, glm::u32vec3 size, u32 mipLevels
 		.pQueueFamilyIndices = &index,
 		.initialLayout = layout };
 
-	VmaAllocationCreateInfo allocInfo{ .usage = memUsage };
+	VmaAllocationCreateInfo allocInfo{ .flags = allocFlags, .usage = memUsage };
+
+	VkResult result = vmaCreateImage(Instance::Allocator(), &info, &allocInfo, &m_Image, &m_Memory, nullptr);
+	if (result != VK_SUCCESS)
+	{
+		return result;
+	}
+
+	Memory::Track(m_Tag, m_Memory);
+
+	m_Aspect = GetAspect(format);
+	m_MipLevels = mipLevels;
+	m_Layers = layers;
+	m_States.assign(mipLevels * layers, ResourceState{ .Layout = layout });
+	return result;
+}
+
+Image::Image(VkImageType type, VkFormat format, glm::u32vec3 size, u32 mipLevels, u32 layers,
+	VkSampleCountFlagBits samples, VkImageUsageFlags usage, VkImageCreateFlags flags)
+	: m_Aliased(true)
+{
+	u32 index = Instance::GraphicsIndex();
+
+	VkImageCreateInfo info{ .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+		.flags = flags,
+		.imageType = type,
+		.format = format,
+		.extent = { size.x, size.y, size.z },
+		.mipLevels = mipLevels,
+		.arrayLayers = layers,
+		.samples = samples,
+		.tiling = VK_IMAGE_TILING_OPTIMAL,
+		.usage = usage,
+		.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+		.queueFamilyIndexCount = 1,
+		.pQueueFamilyIndices = &index,
+		.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED };
+
+	VkCall(vkCreateImage(Instance::Device(), &info, nullptr, &m_Image));
 
-	VkCall(vmaCreateImage(Instance::Allocator(), &info, &allocInfo, &m_Image, &m_Memory, nullptr));
+	m_Aspect = GetAspect(format);
+	m_MipLevels = mipLevels;
+	m_Layers = layers;
+	m_States.resize(mipLevels * layers);
 }
 
-Image::~Image() { vmaDestroyImage(Instance::Allocator(), m_Image, m_Memory); }
+Image::Image(VkImage image) : m_Image(image) {}
+
+Image::~Image() { Destroy(); }
 
 Image::Image(Image&& other)
 {
@@ -84,16 +180,77 @@ Image::Image(Image&& other)
 	other.m_Image = VK_NULL_HANDLE;
 	m_Memory = other.m_Memory;
 	other.m_Memory = VK_NULL_HANDLE;
+	m_Aliased = other.m_Aliased;
+	m_Tag = other.m_Tag;
+	m_Aspect = other.m_Aspect;
+	m_MipLevels = other.m_MipLevels;
+	m_Layers = other.m_Layers;
+	m_States = std::move(other.m_States);
 }
 
 Image& Image::operator=(Image&& other)
 {
-	this->~Image();
+	Destroy();
 
 	m_Image = other.m_Image;
 	other.m_Image = VK_NULL_HANDLE;
 	m_Memory = other.m_Memory;
 	other.m_Memory = VK_NULL_HANDLE;
+	m_Aliased = other.m_Aliased;
+	m_Tag = other.m_Tag;
+	m_Aspect = other.m_Aspect;
+	m_MipLevels = other.m_MipLevels;
+	m_Layers = other.m_Layers;
+	m_States = std::move(other.m_States);
 
 	return *this;
 }
+
+const ResourceState& Image::GetState(u32 mipLevel, u32 layer) const
+{
+	ASSERT(mipLevel < m_MipLevels && layer < m_Layers, "Subresource is out of range");
+
+	return m_States[layer * m_MipLevels + mipLevel];
+}
+
+void Image::SetState(const ResourceState& state, std::optional<VkImageSubresourceRange> range)
+{
+	VkImageSubresourceRange r = range.value_or(GetFullRange());
+	u32 levels = r.levelCount == VK_REMAINING_MIP_LEVELS ? m_MipLevels - r.baseMipLevel : r.levelCount;
+	u32 layers = r.layerCount == VK_REMAINING_ARRAY_LAYERS ? m_Layers - r.baseArrayLayer : r.layerCount;
+	for (u32 layer = r.baseArrayLayer; layer < r.baseArrayLayer + layers; layer++)
+	{
+		for (u32 level = r.baseMipLevel; level < r.baseMipLevel + levels; level++)
+		{
+			m_States[layer * m_MipLevels + level] = state;
+		}
+	}
+}
+
+void Image::Destroy()
+{
+	if (m_Aliased)
+	{
+		vkDestroyImage(Instance::Device(), m_Image, nullptr);
+	}
+	else if (m_Memory)
+	{
+		Memory::Untrack(m_Tag, m_Memory);
+		vmaDestroyImage(Instance::Allocator(), m_Image, m_Memory);
+	}
+}
+
+VkMemoryRequirements Image::GetMemoryRequirements() const
+{
+	VkMemoryRequirements requirements;
+	vkGetImageMemoryRequirements(Instance::Device(), m_Image, &requirements);
+	return requirements;
+}
+
+void Image::Bind(VmaAllocation memory, u64 offset)
+{
+	ASSERT(m_Aliased, "Only images created without memory can be bound");
+
+	m_Memory = memory;
+	VkCall(vmaBindImageMemory2(Instance::Allocator(), m_Memory, offset, m_Image, nullptr));
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Instance.h"
+#include "Memory.h"
+#include "ResourceState.h"
 
 class Image;
 
@@ -23,6 +25,8 @@ public:
 private:
 	friend class Swapchain;
 
+	void Destroy();
+
 	ImageView(VkImage vkImage, VkFormat format, VkImageViewType viewType, VkComponentMapping mapping,
 		VkImageSubresourceRange range, VkImageViewCreateFlags flags = 0);
 
@@ -35,9 +39,17 @@ public:
 	Image() = default;
 	Image(VkImageType type, VkFormat format, glm::u32vec3 size, u32 mipLevels, u32 layers,
 		VkSampleCountFlagBits samples, VkImageUsageFlags usage, VkImageLayout layout, VmaMemoryUsage memUsage,
-		VkImageCreateFlags flags = 0);
+		MemoryTag tag, VkImageCreateFlags flags = 0);
+	// Creates an image without any memory, which has to be bound to shared memory with Bind() before use
+	Image(VkImageType type, VkFormat format, glm::u32vec3 size, u32 mipLevels, u32 layers,
+		VkSampleCountFlagBits samples, VkImageUsageFlags usage, VkImageCreateFlags flags);
 	~Image();
 
+	// Empty instead of going over the memory budget, for content that can be streamed in again later
+	static std::optional<Image> TryCreate(VkImageType type, VkFormat format, glm::u32vec3 size, u32 mipLevels,
+		u32 layers, VkSampleCountFlagBits samples, VkImageUsageFlags usage, VkImageLayout layout,
+		VmaMemoryUsage memUsage, MemoryTag tag, VkImageCreateFlags flags = 0);
+
 	Image(const Image& other) = delete;
 	Image& operator=(const Image& other) = delete;
 
@@ -46,8 +58,35 @@ public:
 
 	VkImage GetHandle() const { return m_Image; }
 	VmaAllocation GetMemory() const { return m_Memory; }
+	MemoryTag GetTag() const { return m_Tag; }
+
+	VkMemoryRequirements GetMemoryRequirements() const;
+	void Bind(VmaAllocation memory, u64 offset);
+
+	VkImageSubresourceRange GetFullRange() const { return { m_Aspect, 0, m_MipLevels, 0, m_Layers }; }
+
+	// Tracked as of the last recorded command buffer, so command buffers must be submitted in recording order
+	const ResourceState& GetState(u32 mipLevel = 0, u32 layer = 0) const;
+	void SetState(const ResourceState& state, std::optional<VkImageSubresourceRange> range = std::nullopt);
 
 private:
+	friend class Swapchain;
+
+	// Doesn't take ownership, used for images owned by a swapchain
+	Image(VkImage image);
+
+	VkResult Allocate(VkImageType type, VkFormat format, glm::u32vec3 size, u32 mipLevels, u32 layers,
+		VkSampleCountFlagBits samples, VkImageUsageFlags usage, VkImageLayout layout, VmaMemoryUsage memUsage,
+		VmaAllocationCreateFlags allocFlags, VkImageCreateFlags flags);
+	void Destroy();
+
 	VkImage m_Image = VK_NULL_HANDLE;
 	VmaAllocation m_Memory = VK_NULL_HANDLE;
+	bool m_Aliased = false;
+	MemoryTag m_Tag = MemoryTag::Other;
+
+	VkImageAspectFlags m_Aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+	u32 m_MipLevels = 1;
+	u32 m_Layers = 1;
+	std::vector<ResourceState> m_States = std::vector<ResourceState>(1);
 };
@@ -27,6 +27,29 @@ VkDebugUtilsMessengerEXT s_DebugMessenger = VK_NULL_HANDLE;
 
 VkQueue s_GraphicsQueue = VK_NULL_HANDLE;
 u32 s_GraphicsQueueIndex;
+std::mutex s_QueueMutex;
+
+struct Batch
+{
+	u32 BufferCount;
+	u32 WaitCount;
+	u32 SignalCount;
+	VkFence Notify;
+};
+
+// Flattened so that enqueueing doesn't allocate once the vectors have grown
+std::mutex s_EnqueueMutex;
+std::vector<Batch> s_Batches;
+std::vector<VkCommandBuffer> s_BatchBuffers;
+std::vector<VkSemaphore> s_BatchWaits;
+std::vector<VkPipelineStageFlags> s_BatchStages;
+std::vector<VkSemaphore> s_BatchSignals;
+CommandStats s_BatchStats;
+
+std::mutex s_StatsMutex;
+CommandStats s_SubmittedStats;
+
+DeviceFeatures s_Features;
 
 template<typename Func, typename... Args>
 auto LoadAndCall(const char* name, const Args&... args)
@@ -250,22 +273,34 @@ VkPhysicalDevice PickPhysicalDevice()
 	}
 }
 
-std::vector<const char*> GetDeviceExtensions(VkPhysicalDevice device)
+std::vector<VkExtensionProperties> GetAvailableExtensions(VkPhysicalDevice device)
 {
 	u32 count;
 	VkCall(vkEnumerateDeviceExtensionProperties(device, nullptr, &count, nullptr));
 	std::vector<VkExtensionProperties> properties(count);
 	VkCall(vkEnumerateDeviceExtensionProperties(device, nullptr, &count, properties.data()));
 
+	return properties;
+}
+
+static bool HasExtension(const std::vector<VkExtensionProperties>& properties, const char* name)
+{
 	for (const auto& extension : properties)
 	{
-		if (strcmp(extension.extensionName, "VK_KHR_portability_subset") == 0)
+		if (std::strcmp(extension.extensionName, name) == 0)
 		{
-			return { "VK_KHR_portability_subset", VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+			return true;
 		}
 	}
 
-	return { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+	return false;
+}
+
+template<typename T>
+static void Chain(void**& next, T& structure)
+{
+	*next = &structure;
+	next = &structure.pNext;
 }
 
 void CreateDevice(VkPhysicalDevice phyDevice)
@@ -284,13 +319,110 @@ void CreateDevice(VkPhysicalDevice phyDevice)
 		queues.emplace_back(info);
 	}
 
-	auto extensions = GetDeviceExtensions(phyDevice);
+	auto available = GetAvailableExtensions(phyDevice);
 	auto layers = GetInstanceLayers();
 
-	VkPhysicalDeviceFeatures features{};
+	std::vector<const char*> extensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+	if (HasExtension(available, "VK_KHR_portability_subset"))
+	{
+		extensions.push_back("VK_KHR_portability_subset");
+	}
+
+	bool hasDynamicState = HasExtension(available, VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+	bool hasDynamicRendering = HasExtension(available, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME)
+							   && HasExtension(available, VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME)
+							   && HasExtension(available, VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME);
+	bool hasSynchronization2 = HasExtension(available, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+
+	VkPhysicalDeviceFeatures2 supported{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+	void** supportedNext = &supported.pNext;
+	VkPhysicalDeviceExtendedDynamicStateFeaturesEXT supportedDynamicState{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT
+	};
+	if (hasDynamicState)
+	{
+		Chain(supportedNext, supportedDynamicState);
+	}
+	VkPhysicalDeviceDynamicRenderingFeaturesKHR supportedDynamicRendering{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR
+	};
+	if (hasDynamicRendering)
+	{
+		Chain(supportedNext, supportedDynamicRendering);
+	}
+	VkPhysicalDeviceSynchronization2FeaturesKHR supportedSynchronization2{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR
+	};
+	if (hasSynchronization2)
+	{
+		Chain(supportedNext, supportedSynchronization2);
+	}
+	vkGetPhysicalDeviceFeatures2(phyDevice, &supported);
+
+	// Only enable what we use, so the driver doesn't have to assume anything else
+	VkPhysicalDeviceFeatures2 features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+	void** next = &features.pNext;
+
+	VkPhysicalDeviceExtendedDynamicStateFeaturesEXT dynamicState{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT, .extendedDynamicState = VK_TRUE
+	};
+	if (hasDynamicState && supportedDynamicState.extendedDynamicState)
+	{
+		extensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+		Chain(next, dynamicState);
+		s_Features.ExtendedDynamicState = true;
+	}
+
+	VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRendering{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR, .dynamicRendering = VK_TRUE
+	};
+	if (hasDynamicRendering && supportedDynamicRendering.dynamicRendering)
+	{
+		extensions.push_back(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME);
+		extensions.push_back(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME);
+		extensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+		Chain(next, dynamicRendering);
+		s_Features.DynamicRendering = true;
+	}
+
+	VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR, .synchronization2 = VK_TRUE
+	};
+	if (hasSynchronization2 && supportedSynchronization2.synchronization2)
+	{
+		extensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+		Chain(next, synchronization2);
+		s_Features.Synchronization2 = true;
+	}
+
+	if (supported.features.pipelineStatisticsQuery)
+	{
+		features.features.pipelineStatisticsQuery = VK_TRUE;
+		s_Features.PipelineStatistics = true;
+	}
+
+	if (supported.features.multiDrawIndirect)
+	{
+		features.features.multiDrawIndirect = VK_TRUE;
+		s_Features.MultiDrawIndirect = true;
+	}
+
+	if (HasExtension(available, VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME))
+	{
+		extensions.push_back(VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME);
+		s_Features.DisplayTiming = true;
+	}
+
+	// Without it VMA can only guess the budget from the heap sizes
+	if (HasExtension(available, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+	{
+		extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		s_Features.MemoryBudget = true;
+	}
 
 	VkDeviceCreateInfo info{
 		.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+		.pNext = &features,
 		.queueCreateInfoCount = u32(queues.size()),
 		.pQueueCreateInfos = queues.data(),
 		.enabledLayerCount = u32(layers.size()),
@@ -303,6 +435,14 @@ void CreateDevice(VkPhysicalDevice phyDevice)
 
 	volkLoadDevice(s_Device);
 
+	DEBUG("Extended dynamic state {}", s_Features.ExtendedDynamicState ? "enabled" : "not supported");
+	DEBUG("Dynamic rendering {}", s_Features.DynamicRendering ? "enabled" : "not supported");
+	DEBUG("Synchronization2 {}", s_Features.Synchronization2 ? "enabled" : "not supported");
+	DEBUG("Display timing {}", s_Features.DisplayTiming ? "enabled" : "not supported");
+	DEBUG("Pipeline statistics {}", s_Features.PipelineStatistics ? "enabled" : "not supported");
+	DEBUG("Memory budget {}", s_Features.MemoryBudget ? "enabled" : "not supported");
+	DEBUG("Multi draw indirect {}", s_Features.MultiDrawIndirect ? "enabled" : "not supported");
+
 	vkGetDeviceQueue(s_Device, families.Graphics.value(), 0, &s_GraphicsQueue);
 	s_GraphicsQueueIndex = families.Graphics.value();
 
@@ -327,11 +467,14 @@ void CreateDevice(VkPhysicalDevice phyDevice)
 		.vkGetImageMemoryRequirements2KHR = vkGetImageMemoryRequirements2KHR,
 		.vkBindBufferMemory2KHR = vkBindBufferMemory2KHR,
 		.vkBindImageMemory2KHR = vkBindImageMemory2KHR,
-		.vkGetPhysicalDeviceMemoryProperties2KHR = vkGetPhysicalDeviceMemoryProperties2KHR };
-
-	VmaAllocatorCreateInfo aInfo{
-		.physicalDevice = phyDevice, .device = s_Device, .pVulkanFunctions = &vkFuncs, .instance = s_Instance
-	};
+		// Core in Vulkan 1.1, which the budget is queried with
+		.vkGetPhysicalDeviceMemoryProperties2KHR = vkGetPhysicalDeviceMemoryProperties2 };
+
+	VmaAllocatorCreateInfo aInfo{ .flags = s_Features.MemoryBudget ? VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT : 0u,
+		.physicalDevice = phyDevice,
+		.device = s_Device,
+		.pVulkanFunctions = &vkFuncs,
+		.instance = s_Instance };
 	VkCall(vmaCreateAllocator(&aInfo, &s_Allocator));
 
 	s_PhysicalDevice = phyDevice;
@@ -373,17 +516,23 @@ u32 GraphicsIndex() { return s_GraphicsQueueIndex; }
 
 VkQueue GraphicsQueue() { return s_GraphicsQueue; }
 
-void WaitForIdle() { vkDeviceWaitIdle(s_Device); }
+const DeviceFeatures& Features() { return s_Features; }
+
+std::unique_lock<std::mutex> LockQueue() { return std::unique_lock(s_QueueMutex); }
+
+void WaitForIdle()
+{
+	auto lock = LockQueue();
+	vkDeviceWaitIdle(s_Device);
+}
 
 void Submit(std::span<CommandBuffer*> buffers, std::span<std::pair<const Semaphore*, VkPipelineStageFlags>> wait,
 	std::span<const Semaphore*> signal, const Fence* notify)
 {
-	// A lot of allocation going on here, so I made it static. Submitting from multiple threads is not allowed, so the
-	// vectors don't have to be thread_local.
-	static std::vector<VkSemaphore> waitSemaphores;
-	static std::vector<VkPipelineStageFlags> waitStages;
-	static std::vector<VkSemaphore> signalSemaphores;
-	static std::vector<VkCommandBuffer> commandBuffers;
+	static thread_local std::vector<VkSemaphore> waitSemaphores;
+	static thread_local std::vector<VkPipelineStageFlags> waitStages;
+	static thread_local std::vector<VkSemaphore> signalSemaphores;
+	static thread_local std::vector<VkCommandBuffer> commandBuffers;
 
 	waitSemaphores.clear();
 	waitStages.clear();
@@ -395,9 +544,11 @@ void Submit(std::span<CommandBuffer*> buffers, std::span<std::pair<const Semapho
 	signalSemaphores.reserve(signal.size());
 	commandBuffers.reserve(buffers.size());
 
+	CommandStats stats;
 	for (auto buffer : buffers)
 	{
 		commandBuffers.push_back(buffer->GetHandle());
+		stats += buffer->GetStats();
 	}
 
 	for (auto pair : wait)
@@ -420,7 +571,122 @@ void Submit(std::span<CommandBuffer*> buffers, std::span<std::pair<const Semapho
 		.signalSemaphoreCount = u32(signalSemaphores.size()),
 		.pSignalSemaphores = signalSemaphores.data() };
 
-	VkCall(vkQueueSubmit(s_GraphicsQueue, 1, &info, notify ? notify->GetHandle() : VK_NULL_HANDLE));
+	{
+		auto lock = LockQueue();
+		VkCall(vkQueueSubmit(s_GraphicsQueue, 1, &info, notify ? notify->GetHandle() : VK_NULL_HANDLE));
+	}
+
+	std::scoped_lock lock(s_StatsMutex);
+	s_SubmittedStats += stats;
+}
+
+void Enqueue(std::span<CommandBuffer*> buffers, std::span<std::pair<const Semaphore*, VkPipelineStageFlags>> wait,
+	std::span<const Semaphore*> signal, const Fence* notify)
+{
+	std::scoped_lock lock(s_EnqueueMutex);
+
+	s_Batches.push_back(Batch{ .BufferCount = u32(buffers.size()),
+		.WaitCount = u32(wait.size()),
+		.SignalCount = u32(signal.size()),
+		.Notify = notify ? notify->GetHandle() : VK_NULL_HANDLE });
+
+	for (auto buffer : buffers)
+	{
+		s_BatchBuffers.push_back(buffer->GetHandle());
+		s_BatchStats += buffer->GetStats();
+	}
+
+	for (auto pair : wait)
+	{
+		s_BatchWaits.push_back(pair.first->GetHandle());
+		s_BatchStages.push_back(pair.second);
+	}
+
+	for (auto sem : signal)
+	{
+		s_BatchSignals.push_back(sem->GetHandle());
+	}
+}
+
+void Flush()
+{
+	// Swapped out so producers can keep enqueueing while we submit
+	static std::vector<Batch> batches;
+	static std::vector<VkCommandBuffer> buffers;
+	static std::vector<VkSemaphore> waits;
+	static std::vector<VkPipelineStageFlags> stages;
+	static std::vector<VkSemaphore> signals;
+	static std::vector<VkSubmitInfo> infos;
+	static std::mutex flushMutex;
+
+	std::scoped_lock flushLock(flushMutex);
+	CommandStats stats;
+	{
+		std::scoped_lock lock(s_EnqueueMutex);
+		batches.swap(s_Batches);
+		buffers.swap(s_BatchBuffers);
+		waits.swap(s_BatchWaits);
+		stages.swap(s_BatchStages);
+		signals.swap(s_BatchSignals);
+		stats = std::exchange(s_BatchStats, CommandStats());
+	}
+
+	if (batches.empty())
+	{
+		return;
+	}
+
+	infos.clear();
+	infos.reserve(batches.size());
+	u64 buffer = 0;
+	u64 wait = 0;
+	u64 signal = 0;
+	for (const auto& batch : batches)
+	{
+		infos.push_back(VkSubmitInfo{ .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.waitSemaphoreCount = batch.WaitCount,
+			.pWaitSemaphores = waits.data() + wait,
+			.pWaitDstStageMask = stages.data() + wait,
+			.commandBufferCount = batch.BufferCount,
+			.pCommandBuffers = buffers.data() + buffer,
+			.signalSemaphoreCount = batch.SignalCount,
+			.pSignalSemaphores = signals.data() + signal });
+
+		buffer += batch.BufferCount;
+		wait += batch.WaitCount;
+		signal += batch.SignalCount;
+	}
+
+	// There is only one fence per submit, so every batch with a fence ends a submit
+	{
+		auto lock = LockQueue();
+		u64 first = 0;
+		for (u64 i = 0; i < batches.size(); i++)
+		{
+			if (batches[i].Notify || i == batches.size() - 1)
+			{
+				VkCall(vkQueueSubmit(s_GraphicsQueue, u32(i + 1 - first), infos.data() + first, batches[i].Notify));
+				first = i + 1;
+			}
+		}
+	}
+
+	{
+		std::scoped_lock lock(s_StatsMutex);
+		s_SubmittedStats += stats;
+	}
+
+	batches.clear();
+	buffers.clear();
+	waits.clear();
+	stages.clear();
+	signals.clear();
+}
+
+CommandStats TakeSubmittedStats()
+{
+	std::scoped_lock lock(s_StatsMutex);
+	return std::exchange(s_SubmittedStats, CommandStats());
 }
 
 }
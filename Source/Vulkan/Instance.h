@@ -7,11 +7,23 @@
 #include "volk.h"
 
 class CommandBuffer;
+struct CommandStats;
 class Fence;
 class Semaphore;
 
 namespace Instance {
 
+struct DeviceFeatures
+{
+	bool ExtendedDynamicState = false;
+	bool DynamicRendering = false;
+	bool Synchronization2 = false;
+	bool DisplayTiming = false;
+	bool PipelineStatistics = false;
+	bool MemoryBudget = false;
+	bool MultiDrawIndirect = false;
+};
+
 void Init();
 void Cleanup();
 
@@ -22,11 +34,25 @@ VmaAllocator Allocator();
 
 u32 GraphicsIndex();
 VkQueue GraphicsQueue();
+// Anything using the graphics queue directly must hold this
+std::unique_lock<std::mutex> LockQueue();
+
+const DeviceFeatures& Features();
 
 void WaitForIdle();
+// Submits immediately, ahead of anything enqueued but not flushed yet
 void Submit(std::span<CommandBuffer*> buffers, std::span<std::pair<const Semaphore*, VkPipelineStageFlags>> wait,
 	std::span<const Semaphore*> signal, const Fence* notify);
 
+// Can be called from any thread, batches are submitted in the order they were enqueued
+void Enqueue(std::span<CommandBuffer*> buffers, std::span<std::pair<const Semaphore*, VkPipelineStageFlags>> wait,
+	std::span<const Semaphore*> signal, const Fence* notify = nullptr);
+// Submits all enqueued batches with as few vkQueueSubmit calls as the fences allow, called once per frame
+void Flush();
+
+// Adds up the stats of every command buffer submitted since the last call, which is meant to happen once per frame
+CommandStats TakeSubmittedStats();
+
 extern bool IsInitialized;
 
 };
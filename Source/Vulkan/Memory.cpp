@@ -0,0 +1,170 @@
+#include "PCH.h"
+
+#include "Memory.h"
+
+namespace Memory {
+
+// The pressure only drops again once the usage is this far below the threshold, so it doesn't flicker
+constexpr f32 PressureHysteresis = 0.05f;
+constexpr auto ReportInterval = std::chrono::seconds(60);
+
+static constexpr const char* TagNames[] = { "other", "textures", "meshes", "uniforms", "staging",
+	"render targets" };
+static_assert(std::size(TagNames) == u32(MemoryTag::Count));
+
+std::array<std::atomic<u64>, u32(MemoryTag::Count)> s_TagUsage{};
+
+std::atomic<MemoryPressure> s_Pressure = MemoryPressure::Normal;
+PressureCallback s_PressureCallback;
+std::chrono::steady_clock::time_point s_LastReport = std::chrono::steady_clock::now();
+
+const char* GetTagName(MemoryTag tag) { return TagNames[u32(tag)]; }
+
+void Track(MemoryTag tag, VmaAllocation allocation)
+{
+	if (allocation)
+	{
+		VmaAllocationInfo info;
+		vmaGetAllocationInfo(Instance::Allocator(), allocation, &info);
+		s_TagUsage[u32(tag)].fetch_add(info.size, std::memory_order_relaxed);
+	}
+}
+
+void Untrack(MemoryTag tag, VmaAllocation allocation)
+{
+	if (allocation)
+	{
+		VmaAllocationInfo info;
+		vmaGetAllocationInfo(Instance::Allocator(), allocation, &info);
+		s_TagUsage[u32(tag)].fetch_sub(info.size, std::memory_order_relaxed);
+	}
+}
+
+u64 GetTagUsage(MemoryTag tag) { return s_TagUsage[u32(tag)].load(std::memory_order_relaxed); }
+
+VmaAllocationCreateFlags GetBudgetFlags()
+{
+	return Instance::Features().MemoryBudget ? VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT : 0;
+}
+
+u32 GetHeapCount()
+{
+	const VkPhysicalDeviceMemoryProperties* properties;
+	vmaGetMemoryProperties(Instance::Allocator(), &properties);
+	return properties->memoryHeapCount;
+}
+
+HeapUsage GetHeapUsage(u32 heap)
+{
+	const VkPhysicalDeviceMemoryProperties* properties;
+	vmaGetMemoryProperties(Instance::Allocator(), &properties);
+	ASSERT(heap < properties->memoryHeapCount, "Memory heap {} doesn't exist", heap);
+
+	VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+	vmaGetBudget(Instance::Allocator(), budgets);
+
+	return HeapUsage{ .Usage = budgets[heap].usage,
+		.Budget = budgets[heap].budget,
+		.BlockBytes = budgets[heap].blockBytes,
+		.AllocationBytes = budgets[heap].allocationBytes,
+		.DeviceLocal = (properties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0 };
+}
+
+MemoryPressure GetPressure() { return s_Pressure.load(std::memory_order_relaxed); }
+
+void SetPressureCallback(PressureCallback callback) { s_PressureCallback = std::move(callback); }
+
+static MemoryPressure GetHeapPressure(const HeapUsage& usage, MemoryPressure current)
+{
+	if (usage.Budget == 0)
+	{
+		return MemoryPressure::Normal;
+	}
+
+	// Rising takes the thresholds as they are, falling has to get below them by the hysteresis
+	f32 fraction = f32(f64(usage.Usage) / f64(usage.Budget));
+	auto above = [&](f32 threshold, MemoryPressure level) {
+		return fraction >= (current >= level ? threshold - PressureHysteresis : threshold);
+	};
+
+	if (above(CriticalPressure, MemoryPressure::Critical))
+	{
+		return MemoryPressure::Critical;
+	}
+	if (above(HighPressure, MemoryPressure::High))
+	{
+		return MemoryPressure::High;
+	}
+	return MemoryPressure::Normal;
+}
+
+void Update(u64 frame)
+{
+	// The budget is only fetched from the driver again when the frame index changes
+	vmaSetCurrentFrameIndex(Instance::Allocator(), u32(frame));
+
+	MemoryPressure current = GetPressure();
+	MemoryPressure pressure = MemoryPressure::Normal;
+	u32 worstHeap = 0;
+	for (u32 heap = 0; heap < GetHeapCount(); heap++)
+	{
+		MemoryPressure heapPressure = GetHeapPressure(GetHeapUsage(heap), current);
+		if (heapPressure > pressure)
+		{
+			pressure = heapPressure;
+			worstHeap = heap;
+		}
+	}
+
+	if (pressure != current)
+	{
+		s_Pressure.store(pressure, std::memory_order_relaxed);
+
+		constexpr const char* PressureNames[] = { "normal", "high", "critical" };
+		if (pressure == MemoryPressure::Normal)
+		{
+			INFO("GPU memory pressure back to normal");
+		}
+		else
+		{
+			WARN("GPU memory pressure {} on heap {}", PressureNames[u32(pressure)], worstHeap);
+		}
+
+		if (s_PressureCallback)
+		{
+			s_PressureCallback(pressure, worstHeap);
+		}
+	}
+
+	auto now = std::chrono::steady_clock::now();
+	if (now - s_LastReport >= ReportInterval)
+	{
+		s_LastReport = now;
+		Report();
+	}
+}
+
+void Report()
+{
+	for (u32 heap = 0; heap < GetHeapCount(); heap++)
+	{
+		HeapUsage usage = GetHeapUsage(heap);
+		INFO("Heap {}{}: {} / {} MB used, {} MB in blocks of which {} MB allocated", heap,
+			usage.DeviceLocal ? " (device local)" : "", usage.Usage >> 20, usage.Budget >> 20, usage.BlockBytes >> 20,
+			usage.AllocationBytes >> 20);
+	}
+
+	for (u32 tag = 0; tag < u32(MemoryTag::Count); tag++)
+	{
+		INFO("  {}: {} KB", TagNames[tag], GetTagUsage(MemoryTag(tag)) >> 10);
+	}
+}
+
+void OutOfMemory(VkResult result, MemoryTag tag, std::string_view what)
+{
+	Report();
+	CRITICAL("Out of {} memory allocating {} for {}", result == VK_ERROR_OUT_OF_HOST_MEMORY ? "host" : "device", what,
+		GetTagName(tag));
+}
+
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Instance.h"
+
+// What an allocation is used for, every Buffer and Image has one
+enum class MemoryTag : u32
+{
+	Other,
+	Textures,
+	Meshes,
+	Uniforms,
+	Staging,
+	RenderTargets,
+	Count
+};
+
+// How close the fullest heap is to its budget
+enum class MemoryPressure : u32
+{
+	Normal,
+	// New content should wait
+	High,
+	// Content should be released
+	Critical
+};
+
+struct HeapUsage
+{
+	// Bytes of this process, and what it can use without hurting performance or running out
+	u64 Usage;
+	u64 Budget;
+	// Bytes in VMA blocks, and the part of them actually used by allocations
+	u64 BlockBytes;
+	u64 AllocationBytes;
+	bool DeviceLocal;
+};
+
+namespace Memory {
+
+// Fractions of the budget
+constexpr f32 HighPressure = 0.8f;
+constexpr f32 CriticalPressure = 0.95f;
+
+// Called with the new pressure and the heap that caused it
+using PressureCallback = std::function<void(MemoryPressure pressure, u32 heap)>;
+
+const char* GetTagName(MemoryTag tag);
+
+// Buffers and images call these for the memory they own
+void Track(MemoryTag tag, VmaAllocation allocation);
+void Untrack(MemoryTag tag, VmaAllocation allocation);
+u64 GetTagUsage(MemoryTag tag);
+// Used by Buffer::TryCreate and Image::TryCreate, so allocations fail instead of going over the budget
+VmaAllocationCreateFlags GetBudgetFlags();
+
+u32 GetHeapCount();
+// As of the last Update, unless something was allocated since
+HeapUsage GetHeapUsage(u32 heap);
+MemoryPressure GetPressure();
+
+// Called from the thread calling Update
+void SetPressureCallback(PressureCallback callback);
+
+// Once per frame. Refreshes the budget, calls the pressure callback whenever the pressure changes and reports
+// every now and then.
+void Update(u64 frame);
+// Logs the usage against the budget per heap, and the usage per tag
+void Report();
+
+// Logs a report and throws, for when an allocation failed
+[[noreturn]] void OutOfMemory(VkResult result, MemoryTag tag, std::string_view what);
+
+};
@@ -2,11 +2,41 @@
 
 #include "Pipeline.h"
 
+#include "Hash.h"
+
 Pipeline::Pipeline(std::span<Shader> shaders, const VertexInput& vertexInput, const Viewport& viewport,
 	const Rasterizer& rasterizer, const Multisample& multisample, const DepthStencil& depthStencil,
 	const BlendState& blendState, const DynamicState& dynamicState, const PipelineLayout& layout,
 	const RenderPass& renderPass, u32 subpass)
 {
+	Create(shaders, vertexInput, viewport, rasterizer, multisample, depthStencil, blendState, dynamicState, layout,
+		renderPass.GetHandle(), subpass, nullptr);
+
+	m_Hash = Hash(shaders, vertexInput, viewport, rasterizer, multisample, depthStencil, blendState, dynamicState,
+		layout, renderPass, subpass);
+}
+
+Pipeline::Pipeline(std::span<Shader> shaders, const VertexInput& vertexInput, const Viewport& viewport,
+	const Rasterizer& rasterizer, const Multisample& multisample, const DepthStencil& depthStencil,
+	const BlendState& blendState, const DynamicState& dynamicState, const PipelineLayout& layout,
+	const RenderingFormats& formats)
+{
+	ASSERT(Instance::Features().DynamicRendering, "Dynamic rendering is not supported on this device");
+
+	Create(shaders, vertexInput, viewport, rasterizer, multisample, depthStencil, blendState, dynamicState, layout,
+		VK_NULL_HANDLE, 0, &formats.GetInfo());
+
+	m_Hash = Hash(shaders, vertexInput, viewport, rasterizer, multisample, depthStencil, blendState, dynamicState,
+		layout, formats);
+}
+
+void Pipeline::Create(std::span<Shader> shaders, const VertexInput& vertexInput, const Viewport& viewport,
+	const Rasterizer& rasterizer, const Multisample& multisample, const DepthStencil& depthStencil,
+	const BlendState& blendState, const DynamicState& dynamicState, const PipelineLayout& layout,
+	VkRenderPass renderPass, u32 subpass, const void* next)
+{
+	m_Topology = vertexInput.GetAssemblyInfo().topology;
+
 	std::vector<VkPipelineShaderStageCreateInfo> stages;
 	stages.reserve(shaders.size());
 	for (const auto& shader : shaders)
@@ -15,6 +45,7 @@ Pipeline::Pipeline(std::span<Shader> shaders, const VertexInput& vertexInput, co
 	}
 
 	VkGraphicsPipelineCreateInfo info{ .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+		.pNext = next,
 		.stageCount = u32(stages.size()),
 		.pStages = stages.data(),
 		.pVertexInputState = &vertexInput.GetInputInfo(),
@@ -26,26 +57,301 @@ Pipeline::Pipeline(std::span<Shader> shaders, const VertexInput& vertexInput, co
 		.pColorBlendState = &blendState.GetInfo(),
 		.pDynamicState = &dynamicState.GetInfo(),
 		.layout = layout.GetHandle(),
-		.renderPass = renderPass.GetHandle(),
+		.renderPass = renderPass,
 		.subpass = subpass };
 
+	ASSERT(!dynamicState.UsesExtendedState() || Instance::Features().ExtendedDynamicState,
+		"Extended dynamic state is not supported on this device");
+
 	VkCall(vkCreateGraphicsPipelines(Instance::Device(), VK_NULL_HANDLE, 1, &info, nullptr, &m_Pipeline));
 }
 
-Pipeline::~Pipeline() { vkDestroyPipeline(Instance::Device(), m_Pipeline, nullptr); }
+Pipeline::~Pipeline() { Destroy(); }
 
 Pipeline::Pipeline(Pipeline&& other)
 {
 	m_Pipeline = other.m_Pipeline;
 	other.m_Pipeline = VK_NULL_HANDLE;
+	m_Hash = other.m_Hash;
+	m_Topology = other.m_Topology;
 }
 
 Pipeline& Pipeline::operator=(Pipeline&& other)
 {
-	this->~Pipeline();
+	Destroy();
 
 	m_Pipeline = other.m_Pipeline;
 	other.m_Pipeline = VK_NULL_HANDLE;
+	m_Hash = other.m_Hash;
+	m_Topology = other.m_Topology;
 
 	return *this;
 }
+
+void Pipeline::Destroy() { vkDestroyPipeline(Instance::Device(), m_Pipeline, nullptr); }
+
+// With dynamic topology only the topology class has to match the pipeline
+static u32 GetTopologyClass(VkPrimitiveTopology topology)
+{
+	switch (topology)
+	{
+	case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:
+		return 0;
+	case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+	case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+	case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+	case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+		return 1;
+	case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST:
+		return 3;
+	default:
+		return 2;
+	}
+}
+
+static u64 HashVertexInput(u64 hash, const VertexInput& vertexInput, const DynamicState& dynamic)
+{
+	const auto& input = vertexInput.GetInputInfo();
+	for (u32 i = 0; i < input.vertexBindingDescriptionCount; i++)
+	{
+		const auto& binding = input.pVertexBindingDescriptions[i];
+		hash = HashValue(hash, binding.binding);
+		if (!dynamic.Contains(VK_DYNAMIC_STATE_VERTEX_INPUT_BINDING_STRIDE_EXT))
+		{
+			hash = HashValue(hash, binding.stride);
+		}
+		hash = HashValue(hash, binding.inputRate);
+	}
+	for (u32 i = 0; i < input.vertexAttributeDescriptionCount; i++)
+	{
+		const auto& attribute = input.pVertexAttributeDescriptions[i];
+		hash = HashValue(hash, attribute.location);
+		hash = HashValue(hash, attribute.binding);
+		hash = HashValue(hash, attribute.format);
+		hash = HashValue(hash, attribute.offset);
+	}
+
+	const auto& assembly = vertexInput.GetAssemblyInfo();
+	if (dynamic.Contains(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT))
+	{
+		hash = HashValue(hash, GetTopologyClass(assembly.topology));
+	}
+	else
+	{
+		hash = HashValue(hash, assembly.topology);
+	}
+	return HashValue(hash, assembly.primitiveRestartEnable);
+}
+
+static u64 HashViewport(u64 hash, const Viewport& viewport, const DynamicState& dynamic)
+{
+	if (!dynamic.Contains(VK_DYNAMIC_STATE_VIEWPORT) && !dynamic.Contains(VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT_EXT))
+	{
+		const auto& view = viewport.GetViewport();
+		hash = HashValue(hash, view.x);
+		hash = HashValue(hash, view.y);
+		hash = HashValue(hash, view.width);
+		hash = HashValue(hash, view.height);
+		hash = HashValue(hash, view.minDepth);
+		hash = HashValue(hash, view.maxDepth);
+	}
+
+	if (!dynamic.Contains(VK_DYNAMIC_STATE_SCISSOR) && !dynamic.Contains(VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT_EXT))
+	{
+		const auto& scissor = viewport.GetScissor();
+		hash = HashValue(hash, scissor.offset.x);
+		hash = HashValue(hash, scissor.offset.y);
+		hash = HashValue(hash, scissor.extent.width);
+		hash = HashValue(hash, scissor.extent.height);
+	}
+
+	return hash;
+}
+
+static u64 HashRasterizer(u64 hash, const Rasterizer& rasterizer, const DynamicState& dynamic)
+{
+	const auto& info = rasterizer.GetInfo();
+	hash = HashValue(hash, info.depthClampEnable);
+	hash = HashValue(hash, info.rasterizerDiscardEnable);
+	hash = HashValue(hash, info.polygonMode);
+	if (!dynamic.Contains(VK_DYNAMIC_STATE_LINE_WIDTH))
+	{
+		hash = HashValue(hash, info.lineWidth);
+	}
+	if (!dynamic.Contains(VK_DYNAMIC_STATE_CULL_MODE_EXT))
+	{
+		hash = HashValue(hash, info.cullMode);
+	}
+	if (!dynamic.Contains(VK_DYNAMIC_STATE_FRONT_FACE_EXT))
+	{
+		hash = HashValue(hash, info.frontFace);
+	}
+	hash = HashValue(hash, info.depthBiasEnable);
+	if (!dynamic.Contains(VK_DYNAMIC_STATE_DEPTH_BIAS))
+	{
+		hash = HashValue(hash, info.depthBiasConstantFactor);
+		hash = HashValue(hash, info.depthBiasClamp);
+		hash = HashValue(hash, info.depthBiasSlopeFactor);
+	}
+
+	return hash;
+}
+
+static u64 HashMultisample(u64 hash, const Multisample& multisample)
+{
+	const auto& info = multisample.GetInfo();
+	hash = HashValue(hash, info.sampleShadingEnable);
+	hash = HashValue(hash, info.rasterizationSamples);
+	hash = HashValue(hash, info.minSampleShading);
+	hash = HashValue(hash, info.alphaToCoverageEnable);
+	return HashValue(hash, info.alphaToOneEnable);
+}
+
+static u64 HashStencilOp(u64 hash, const VkStencilOpState& op, const DynamicState& dynamic)
+{
+	if (!dynamic.Contains(VK_DYNAMIC_STATE_STENCIL_OP_EXT))
+	{
+		hash = HashValue(hash, op.failOp);
+		hash = HashValue(hash, op.passOp);
+		hash = HashValue(hash, op.depthFailOp);
+		hash = HashValue(hash, op.compareOp);
+	}
+	if (!dynamic.Contains(VK_DYNAMIC_STATE_STENCIL_COMPARE_MASK))
+	{
+		hash = HashValue(hash, op.compareMask);
+	}
+	if (!dynamic.Contains(VK_DYNAMIC_STATE_STENCIL_WRITE_MASK))
+	{
+		hash = HashValue(hash, op.writeMask);
+	}
+	if (!dynamic.Contains(VK_DYNAMIC_STATE_STENCIL_REFERENCE))
+	{
+		hash = HashValue(hash, op.reference);
+	}
+
+	return hash;
+}
+
+static u64 HashDepthStencil(u64 hash, const DepthStencil& depthStencil, const DynamicState& dynamic)
+{
+	const auto& info = depthStencil.GetInfo();
+	if (!dynamic.Contains(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT))
+	{
+		hash = HashValue(hash, info.depthTestEnable);
+	}
+	if (!dynamic.Contains(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT))
+	{
+		hash = HashValue(hash, info.depthWriteEnable);
+	}
+	if (!dynamic.Contains(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT))
+	{
+		hash = HashValue(hash, info.depthCompareOp);
+	}
+	if (!dynamic.Contains(VK_DYNAMIC_STATE_DEPTH_BOUNDS_TEST_ENABLE_EXT))
+	{
+		hash = HashValue(hash, info.depthBoundsTestEnable);
+	}
+	if (!dynamic.Contains(VK_DYNAMIC_STATE_DEPTH_BOUNDS))
+	{
+		hash = HashValue(hash, info.minDepthBounds);
+		hash = HashValue(hash, info.maxDepthBounds);
+	}
+	if (!dynamic.Contains(VK_DYNAMIC_STATE_STENCIL_TEST_ENABLE_EXT))
+	{
+		hash = HashValue(hash, info.stencilTestEnable);
+	}
+
+	hash = HashStencilOp(hash, info.front, dynamic);
+	return HashStencilOp(hash, info.back, dynamic);
+}
+
+static u64 HashBlendState(u64 hash, const BlendState& blendState, const DynamicState& dynamic)
+{
+	const auto& info = blendState.GetInfo();
+	hash = HashValue(hash, info.logicOpEnable);
+	hash = HashValue(hash, info.logicOp);
+	if (!dynamic.Contains(VK_DYNAMIC_STATE_BLEND_CONSTANTS))
+	{
+		for (float constant : info.blendConstants)
+		{
+			hash = HashValue(hash, constant);
+		}
+	}
+	for (u32 i = 0; i < info.attachmentCount; i++)
+	{
+		const auto& attachment = info.pAttachments[i];
+		hash = HashValue(hash, attachment.blendEnable);
+		hash = HashValue(hash, attachment.srcColorBlendFactor);
+		hash = HashValue(hash, attachment.dstColorBlendFactor);
+		hash = HashValue(hash, attachment.colorBlendOp);
+		hash = HashValue(hash, attachment.srcAlphaBlendFactor);
+		hash = HashValue(hash, attachment.dstAlphaBlendFactor);
+		hash = HashValue(hash, attachment.alphaBlendOp);
+		hash = HashValue(hash, attachment.colorWriteMask);
+	}
+
+	return hash;
+}
+
+static u64 HashDynamicState(u64 hash, const DynamicState& dynamicState)
+{
+	// Sorted, so that the same states listed in a different order give the same hash
+	const auto& info = dynamicState.GetInfo();
+	std::vector<VkDynamicState> states(info.pDynamicStates, info.pDynamicStates + info.dynamicStateCount);
+	std::sort(states.begin(), states.end());
+	for (auto state : states)
+	{
+		hash = HashValue(hash, state);
+	}
+
+	return hash;
+}
+
+u64 Pipeline::Hash(std::span<Shader> shaders, const VertexInput& vertexInput, const Viewport& viewport,
+	const Rasterizer& rasterizer, const Multisample& multisample, const DepthStencil& depthStencil,
+	const BlendState& blendState, const DynamicState& dynamicState, const PipelineLayout& layout,
+	const RenderPass& renderPass, u32 subpass)
+{
+	u64 hash = HashState(shaders, vertexInput, viewport, rasterizer, multisample, depthStencil, blendState,
+		dynamicState, layout);
+	hash = HashValue(hash, renderPass.GetHandle());
+	return HashValue(hash, subpass);
+}
+
+u64 Pipeline::Hash(std::span<Shader> shaders, const VertexInput& vertexInput, const Viewport& viewport,
+	const Rasterizer& rasterizer, const Multisample& multisample, const DepthStencil& depthStencil,
+	const BlendState& blendState, const DynamicState& dynamicState, const PipelineLayout& layout,
+	const RenderingFormats& formats)
+{
+	u64 hash = HashState(shaders, vertexInput, viewport, rasterizer, multisample, depthStencil, blendState,
+		dynamicState, layout);
+
+	const auto& info = formats.GetInfo();
+	for (u32 i = 0; i < info.colorAttachmentCount; i++)
+	{
+		hash = HashValue(hash, info.pColorAttachmentFormats[i]);
+	}
+	hash = HashValue(hash, info.depthAttachmentFormat);
+	return HashValue(hash, info.stencilAttachmentFormat);
+}
+
+u64 Pipeline::HashState(std::span<Shader> shaders, const VertexInput& vertexInput, const Viewport& viewport,
+	const Rasterizer& rasterizer, const Multisample& multisample, const DepthStencil& depthStencil,
+	const BlendState& blendState, const DynamicState& dynamicState, const PipelineLayout& layout)
+{
+	u64 hash = HashSeed;
+	for (const auto& shader : shaders)
+	{
+		hash = HashValue(hash, shader.Hash());
+	}
+
+	// State that is set dynamically is left out, so that pipelines which only differ in it are shared
+	hash = HashVertexInput(hash, vertexInput, dynamicState);
+	hash = HashViewport(hash, viewport, dynamicState);
+	hash = HashRasterizer(hash, rasterizer, dynamicState);
+	hash = HashMultisample(hash, multisample);
+	hash = HashDepthStencil(hash, depthStencil, dynamicState);
+	hash = HashBlendState(hash, blendState, dynamicState);
+	hash = HashDynamicState(hash, dynamicState);
+	return HashValue(hash, layout.GetHandle());
+}
@@ -16,6 +16,11 @@ public:
 		const Rasterizer& rasterizer, const Multisample& multisample, const DepthStencil& depthStencil,
 		const BlendState& blendState, const DynamicState& dynamicState, const PipelineLayout& layout,
 		const RenderPass& renderPass, u32 subpass);
+	// For use with CommandBuffer::BeginRendering, doesn't need a render pass
+	Pipeline(std::span<Shader> shaders, const VertexInput& vertexInput, const Viewport& viewport,
+		const Rasterizer& rasterizer, const Multisample& multisample, const DepthStencil& depthStencil,
+		const BlendState& blendState, const DynamicState& dynamicState, const PipelineLayout& layout,
+		const RenderingFormats& formats);
 	~Pipeline();
 
 	Pipeline(const Pipeline& other) = delete;
@@ -24,8 +29,32 @@ public:
 	Pipeline(Pipeline&& other);
 	Pipeline& operator=(Pipeline&& other);
 
+	static u64 Hash(std::span<Shader> shaders, const VertexInput& vertexInput, const Viewport& viewport,
+		const Rasterizer& rasterizer, const Multisample& multisample, const DepthStencil& depthStencil,
+		const BlendState& blendState, const DynamicState& dynamicState, const PipelineLayout& layout,
+		const RenderPass& renderPass, u32 subpass);
+	static u64 Hash(std::span<Shader> shaders, const VertexInput& vertexInput, const Viewport& viewport,
+		const Rasterizer& rasterizer, const Multisample& multisample, const DepthStencil& depthStencil,
+		const BlendState& blendState, const DynamicState& dynamicState, const PipelineLayout& layout,
+		const RenderingFormats& formats);
+
 	VkPipeline GetHandle() const { return m_Pipeline; }
+	u64 GetHash() const { return m_Hash; }
+	VkPrimitiveTopology GetTopology() const { return m_Topology; }
 
 private:
+	void Destroy();
+
+	void Create(std::span<Shader> shaders, const VertexInput& vertexInput, const Viewport& viewport,
+		const Rasterizer& rasterizer, const Multisample& multisample, const DepthStencil& depthStencil,
+		const BlendState& blendState, const DynamicState& dynamicState, const PipelineLayout& layout,
+		VkRenderPass renderPass, u32 subpass, const void* next);
+
+	static u64 HashState(std::span<Shader> shaders, const VertexInput& vertexInput, const Viewport& viewport,
+		const Rasterizer& rasterizer, const Multisample& multisample, const DepthStencil& depthStencil,
+		const BlendState& blendState, const DynamicState& dynamicState, const PipelineLayout& layout);
+
 	VkPipeline m_Pipeline = VK_NULL_HANDLE;
+	u64 m_Hash = 0;
+	VkPrimitiveTopology m_Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 };
@@ -58,15 +58,7 @@ PipelineLayout::PipelineLayout(std::span<std::vector<DescriptorBinding>> layouts
 	VkCall(vkCreatePipelineLayout(Instance::Device(), &info, nullptr, &m_Layout));
 }
 
-PipelineLayout::~PipelineLayout()
-{
-	vkDestroyPipelineLayout(Instance::Device(), m_Layout, nullptr);
-
-	for (VkDescriptorSetLayout layout : m_DescriptorLayouts)
-	{
-		vkDestroyDescriptorSetLayout(Instance::Device(), layout, nullptr);
-	}
-}
+PipelineLayout::~PipelineLayout() { Destroy(); }
 
 PipelineLayout::PipelineLayout(PipelineLayout&& other)
 {
@@ -77,7 +69,7 @@ PipelineLayout::PipelineLayout(PipelineLayout&& other)
 
 PipelineLayout& PipelineLayout::operator=(PipelineLayout&& other)
 {
-	this->~PipelineLayout();
+	Destroy();
 
 	m_Layout = other.m_Layout;
 	other.m_Layout = VK_NULL_HANDLE;
@@ -85,3 +77,13 @@ PipelineLayout& PipelineLayout::operator=(PipelineLayout&& other)
 
 	return *this;
 }
+
+void PipelineLayout::Destroy()
+{
+	vkDestroyPipelineLayout(Instance::Device(), m_Layout, nullptr);
+
+	for (VkDescriptorSetLayout layout : m_DescriptorLayouts)
+	{
+		vkDestroyDescriptorSetLayout(Instance::Device(), layout, nullptr);
+	}
+}
@@ -38,6 +38,8 @@ public:
 	}
 
 private:
+	void Destroy();
+
 	VkPipelineLayout m_Layout = VK_NULL_HANDLE;
 	std::vector<VkDescriptorSetLayout> m_DescriptorLayouts;
 };
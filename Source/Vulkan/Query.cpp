@@ -0,0 +1,66 @@
+#include "PCH.h"
+
+#include "Query.h"
+
+QueryPool::QueryPool(VkQueryType type, u32 count, VkQueryPipelineStatisticFlags statistics) : m_Count(count)
+{
+	VkQueryPoolCreateInfo info{ .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+		.queryType = type,
+		.queryCount = count,
+		.pipelineStatistics = statistics };
+
+	VkCall(vkCreateQueryPool(Instance::Device(), &info, nullptr, &m_Pool));
+}
+
+QueryPool::~QueryPool() { Destroy(); }
+
+QueryPool::QueryPool(QueryPool&& other)
+{
+	m_Pool = other.m_Pool;
+	other.m_Pool = VK_NULL_HANDLE;
+	m_Count = other.m_Count;
+}
+
+QueryPool& QueryPool::operator=(QueryPool&& other)
+{
+	Destroy();
+
+	m_Pool = other.m_Pool;
+	other.m_Pool = VK_NULL_HANDLE;
+	m_Count = other.m_Count;
+
+	return *this;
+}
+
+void QueryPool::Destroy() { vkDestroyQueryPool(Instance::Device(), m_Pool, nullptr); }
+
+bool QueryPool::GetResults(u32 first, u32 count, std::span<u64> results, u64 stride) const
+{
+	VkResult res = vkGetQueryPoolResults(Instance::Device(), m_Pool, first, count, results.size_bytes(),
+		results.data(), stride, VK_QUERY_RESULT_64_BIT);
+
+	if (res == VK_NOT_READY)
+	{
+		return false;
+	}
+	else if (res != VK_SUCCESS)
+	{
+		CRITICAL("Failed to get query results");
+	}
+
+	return true;
+}
+
+bool QueryPool::SupportsTimestamps()
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(Instance::PhysicalDevice(), &properties);
+	return properties.limits.timestampComputeAndGraphics;
+}
+
+f64 QueryPool::GetTimestampPeriod()
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(Instance::PhysicalDevice(), &properties);
+	return properties.limits.timestampPeriod;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Instance.h"
+
+class QueryPool
+{
+public:
+	QueryPool() = default;
+	// Statistics are only used by pipeline statistics pools
+	QueryPool(VkQueryType type, u32 count, VkQueryPipelineStatisticFlags statistics = 0);
+	~QueryPool();
+
+	QueryPool(const QueryPool& other) = delete;
+	QueryPool& operator=(const QueryPool& other) = delete;
+
+	QueryPool(QueryPool&& other);
+	QueryPool& operator=(QueryPool&& other);
+
+	VkQueryPool GetHandle() const { return m_Pool; }
+	u32 GetCount() const { return m_Count; }
+
+	// Doesn't wait, returns false if any of the queries isn't available yet. Each query writes as many 64-bit values
+	// as it has results, e.g. one per enabled statistic.
+	bool GetResults(u32 first, u32 count, std::span<u64> results, u64 stride = sizeof(u64)) const;
+
+	// Whether timestamps can be written on the graphics queue, and how many nanoseconds a tick is
+	static bool SupportsTimestamps();
+	static f64 GetTimestampPeriod();
+
+private:
+	void Destroy();
+
+	VkQueryPool m_Pool = VK_NULL_HANDLE;
+	u32 m_Count = 0;
+};
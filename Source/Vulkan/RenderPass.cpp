@@ -34,7 +34,7 @@ RenderPass::RenderPass(std::span<VkAttachmentDescription> attachments, std::span
 	VkCall(vkCreateRenderPass(Instance::Device(), &info, nullptr, &m_Pass));
 }
 
-RenderPass::~RenderPass() { vkDestroyRenderPass(Instance::Device(), m_Pass, nullptr); }
+RenderPass::~RenderPass() { Destroy(); }
 
 RenderPass::RenderPass(RenderPass&& other)
 {
@@ -44,10 +44,12 @@ RenderPass::RenderPass(RenderPass&& other)
 
 RenderPass& RenderPass::operator=(RenderPass&& other)
 {
-	this->~RenderPass();
+	Destroy();
 
 	m_Pass = other.m_Pass;
 	other.m_Pass = VK_NULL_HANDLE;
 
 	return *this;
 }
+
+void RenderPass::Destroy() { vkDestroyRenderPass(Instance::Device(), m_Pass, nullptr); }
@@ -29,5 +29,7 @@ public:
 	VkRenderPass GetHandle() const { return m_Pass; }
 
 private:
+	void Destroy();
+
 	VkRenderPass m_Pass = VK_NULL_HANDLE;
 };
@@ -0,0 +1,97 @@
+#include "PCH.h"
+
+#include "ResourceState.h"
+
+VkPipelineStageFlags StagesForAccess(VkAccessFlags access)
+{
+	constexpr VkPipelineStageFlags shaders = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT
+											 | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+											 | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+	VkPipelineStageFlags stages = 0;
+	if (access & VK_ACCESS_INDIRECT_COMMAND_READ_BIT)
+	{
+		stages |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+	}
+	if (access & (VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT))
+	{
+		stages |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+	}
+	if (access & (VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT))
+	{
+		stages |= shaders;
+	}
+	if (access & VK_ACCESS_INPUT_ATTACHMENT_READ_BIT)
+	{
+		stages |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	}
+	if (access & (VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT))
+	{
+		stages |= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	}
+	if (access & (VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT))
+	{
+		stages |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	}
+	if (access & (VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT))
+	{
+		stages |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+	}
+	if (access & (VK_ACCESS_HOST_READ_BIT | VK_ACCESS_HOST_WRITE_BIT))
+	{
+		stages |= VK_PIPELINE_STAGE_HOST_BIT;
+	}
+	if (access & (VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT))
+	{
+		stages |= VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	}
+
+	// No access at all, e.g. presentation
+	return stages ? stages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+}
+
+std::optional<Dependency> TransitionState(
+	ResourceState& state, VkImageLayout layout, VkAccessFlags access, VkPipelineStageFlags stages)
+{
+	bool write = access & WriteAccessMask;
+	if (layout != state.Layout || write)
+	{
+		Dependency dependency{ .SourceStages = state.WriteStages | state.ReadStages,
+			.DestinationStages = stages,
+			.Source = state.WriteAccess,
+			.Destination = access,
+			.From = state.Layout,
+			.To = layout };
+
+		// A layout transition is a write too, so later reads from other stages have to wait on it
+		state = ResourceState{ .Layout = layout,
+			.WriteStages = stages,
+			.WriteAccess = access & WriteAccessMask,
+			.ReadStages = write ? 0 : stages,
+			.ReadAccess = write ? 0 : access };
+
+		if (!dependency.SourceStages && dependency.From == dependency.To)
+		{
+			return std::nullopt;
+		}
+		return dependency;
+	}
+
+	if (state.WriteStages && ((stages & ~state.ReadStages) || (access & ~state.ReadAccess)))
+	{
+		Dependency dependency{ .SourceStages = state.WriteStages,
+			.DestinationStages = stages,
+			.Source = state.WriteAccess,
+			.Destination = access,
+			.From = layout,
+			.To = layout };
+
+		state.ReadStages |= stages;
+		state.ReadAccess |= access;
+		return dependency;
+	}
+
+	state.ReadStages |= stages;
+	state.ReadAccess |= access;
+	return std::nullopt;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Instance.h"
+
+constexpr VkAccessFlags WriteAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+										  | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT
+										  | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+// The last write to a resource, and the reads that have already waited on it. Layout is ignored for buffers.
+struct ResourceState
+{
+	VkImageLayout Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+	VkPipelineStageFlags WriteStages = 0;
+	VkAccessFlags WriteAccess = 0;
+	VkPipelineStageFlags ReadStages = 0;
+	VkAccessFlags ReadAccess = 0;
+
+	bool operator==(const ResourceState& other) const = default;
+};
+
+struct Dependency
+{
+	VkPipelineStageFlags SourceStages;
+	VkPipelineStageFlags DestinationStages;
+	VkAccessFlags Source;
+	VkAccessFlags Destination;
+	VkImageLayout From;
+	VkImageLayout To;
+};
+
+// Only the vertex, fragment and compute stages are assumed for shader accesses
+VkPipelineStageFlags StagesForAccess(VkAccessFlags access);
+
+// Moves the state to a new use, returning what has to be waited on first. Read after read needs no dependency.
+std::optional<Dependency> TransitionState(
+	ResourceState& state, VkImageLayout layout, VkAccessFlags access, VkPipelineStageFlags stages);
@@ -28,7 +28,7 @@ Sampler::Sampler(VkFilter min, VkFilter mag, VkSamplerAddressMode modeU, VkSampl
 	VkCall(vkCreateSampler(Instance::Device(), &info, nullptr, &m_Sampler));
 }
 
-Sampler::~Sampler() { vkDestroySampler(Instance::Device(), m_Sampler, nullptr); }
+Sampler::~Sampler() { Destroy(); }
 
 Sampler::Sampler(Sampler&& other)
 {
@@ -38,10 +38,12 @@ Sampler::Sampler(Sampler&& other)
 
 Sampler& Sampler::operator=(Sampler&& other)
 {
-	this->~Sampler();
+	Destroy();
 
 	m_Sampler = other.m_Sampler;
 	other.m_Sampler = VK_NULL_HANDLE;
 
 	return *this;
 }
+
+void Sampler::Destroy() { vkDestroySampler(Instance::Device(), m_Sampler, nullptr); }
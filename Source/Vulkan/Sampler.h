@@ -24,5 +24,7 @@ public:
 	VkSampler GetHandle() const { return m_Sampler; }
 
 private:
+	void Destroy();
+
 	VkSampler m_Sampler = VK_NULL_HANDLE;
 };
@@ -2,6 +2,60 @@
 
 #include "Shader.h"
 
+#include "Hash.h"
+
+Specialization::Specialization(const Specialization& other)
+{
+	m_Entries = other.m_Entries;
+	m_Data = other.m_Data;
+	Link();
+}
+
+Specialization& Specialization::operator=(const Specialization& other)
+{
+	m_Entries = other.m_Entries;
+	m_Data = other.m_Data;
+	Link();
+
+	return *this;
+}
+
+Specialization::Specialization(Specialization&& other)
+{
+	m_Entries = std::move(other.m_Entries);
+	m_Data = std::move(other.m_Data);
+	Link();
+}
+
+Specialization& Specialization::operator=(Specialization&& other)
+{
+	m_Entries = std::move(other.m_Entries);
+	m_Data = std::move(other.m_Data);
+	Link();
+
+	return *this;
+}
+
+u64 Specialization::Hash() const
+{
+	u64 hash = HashSeed;
+	for (const auto& entry : m_Entries)
+	{
+		hash = HashValue(hash, entry.constantID);
+		hash = HashBytes(m_Data.data() + entry.offset, entry.size, hash);
+	}
+
+	return hash;
+}
+
+void Specialization::Link()
+{
+	m_Info.mapEntryCount = u32(m_Entries.size());
+	m_Info.pMapEntries = m_Entries.data();
+	m_Info.dataSize = m_Data.size();
+	m_Info.pData = m_Data.data();
+}
+
 Shader::Shader(const std::string& filePath, VkShaderStageFlagBits stage, const std::string& entry) : m_Entry(entry)
 {
 	std::ifstream file(filePath, std::ios::ate | std::ios::binary);
@@ -25,7 +79,7 @@ Shader::Shader(const std::string& filePath, VkShaderStageFlagBits stage, const s
 	m_Stage.pName = m_Entry.c_str();
 }
 
-Shader::~Shader() { vkDestroyShaderModule(Instance::Device(), m_Module, nullptr); }
+Shader::~Shader() { Destroy(); }
 
 Shader::Shader(Shader&& other)
 {
@@ -34,17 +88,38 @@ Shader::Shader(Shader&& other)
 	m_Stage = other.m_Stage;
 	m_Entry = std::move(other.m_Entry);
 	m_Stage.pName = m_Entry.c_str(); // Should not have changed due to the move, but let's be safe
+	m_Specialization = std::move(other.m_Specialization);
+	m_Stage.pSpecializationInfo = m_Specialization.IsEmpty() ? nullptr : &m_Specialization.GetInfo();
 }
 
 Shader& Shader::operator=(Shader&& other)
 {
-	this->~Shader();
+	Destroy();
 
 	m_Module = other.m_Module;
 	other.m_Module = VK_NULL_HANDLE;
 	m_Stage = other.m_Stage;
 	m_Entry = std::move(other.m_Entry);
 	m_Stage.pName = m_Entry.c_str(); // Should not have changed due to the move, but let's be safe
+	m_Specialization = std::move(other.m_Specialization);
+	m_Stage.pSpecializationInfo = m_Specialization.IsEmpty() ? nullptr : &m_Specialization.GetInfo();
 
 	return *this;
 }
+
+void Shader::Destroy() { vkDestroyShaderModule(Instance::Device(), m_Module, nullptr); }
+
+void Shader::SetSpecialization(const Specialization& specialization)
+{
+	m_Specialization = specialization;
+	m_Stage.pSpecializationInfo = m_Specialization.IsEmpty() ? nullptr : &m_Specialization.GetInfo();
+}
+
+u64 Shader::Hash() const
+{
+	u64 hash = HashValue(HashSeed, m_Module);
+	hash = HashValue(hash, m_Stage.stage);
+	hash = HashBytes(m_Entry.data(), m_Entry.size(), hash);
+
+	return HashValue(hash, m_Specialization.Hash());
+}
@@ -2,6 +2,50 @@
 
 #include "Instance.h"
 
+// Maps a member of a constant struct to a constant_id in the shader. Use VkBool32 for bool constants.
+#define SPECIALIZATION(type, member, id)                                                                               \
+	VkSpecializationMapEntry { u32(id), u32(offsetof(type, member)), sizeof(type::member) }
+
+class Specialization
+{
+public:
+	Specialization() = default;
+
+	template<typename T>
+	Specialization(const T& constants, std::initializer_list<VkSpecializationMapEntry> entries)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Specialization constants must be trivially copyable");
+
+		m_Data.resize(sizeof(T));
+		std::memcpy(m_Data.data(), &constants, sizeof(T));
+		m_Entries = entries;
+		for (const auto& entry : m_Entries)
+		{
+			ASSERT(entry.offset + entry.size <= sizeof(T), "Specialization constant {} is out of range", entry.constantID);
+		}
+
+		Link();
+	}
+
+	Specialization(const Specialization& other);
+	Specialization& operator=(const Specialization& other);
+
+	Specialization(Specialization&& other);
+	Specialization& operator=(Specialization&& other);
+
+	bool IsEmpty() const { return m_Entries.empty(); }
+	const VkSpecializationInfo& GetInfo() const { return m_Info; }
+
+	u64 Hash() const;
+
+private:
+	void Link();
+
+	VkSpecializationInfo m_Info{};
+	std::vector<VkSpecializationMapEntry> m_Entries;
+	std::vector<u8> m_Data;
+};
+
 class Shader
 {
 public:
@@ -15,10 +59,18 @@ public:
 	Shader(Shader&& other);
 	Shader& operator=(Shader&& other);
 
+	// Only has to stay the same until the pipeline is created, so one module can be reused for multiple variants
+	void SetSpecialization(const Specialization& specialization);
+
 	const VkPipelineShaderStageCreateInfo& GetInfo() const { return m_Stage; }
 
+	u64 Hash() const;
+
 private:
+	void Destroy();
+
 	VkShaderModule m_Module = VK_NULL_HANDLE;
 	VkPipelineShaderStageCreateInfo m_Stage{ .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
 	std::string m_Entry;
+	Specialization m_Specialization;
 };
@@ -11,16 +11,16 @@ Swapchain::Swapchain(GLFWwindow* target) : m_Window(target)
 	VkCall(glfwCreateWindowSurface(Instance::Instance(), target, nullptr, &m_Surface));
 	glfwSetFramebufferSizeCallback(target, &FramebufferResizeCallback);
 
-	Recreate();
+	int width, height;
+	glfwGetFramebufferSize(target, &width, &height);
+	m_FramebufferSize = glm::u32vec2(width, height);
+
+	Recreate(0);
 
 	TRACE("Created swapchain");
 }
 
-Swapchain::~Swapchain()
-{
-	vkDestroySwapchainKHR(Instance::Device(), m_Swapchain, nullptr);
-	vkDestroySurfaceKHR(Instance::Instance(), m_Surface, nullptr);
-}
+Swapchain::~Swapchain() { Destroy(); }
 
 Swapchain::Swapchain(Swapchain&& other)
 {
@@ -34,16 +34,20 @@ Swapchain::Swapchain(Swapchain&& other)
 	m_Format = other.m_Format;
 	m_Stalled = other.m_Stalled;
 	m_Size = other.m_Size;
+	m_FramebufferSize = other.m_FramebufferSize.load();
+	m_RecreatePending = other.m_RecreatePending.load();
+	m_Policy = other.m_Policy.load();
 
 	m_Images = std::move(other.m_Images);
 	m_Views = std::move(other.m_Views);
+	m_Retired = std::move(other.m_Retired);
 	m_PreResizeCallback = std::move(other.m_PreResizeCallback);
 	m_PostResizeCallback = std::move(other.m_PostResizeCallback);
 }
 
 Swapchain& Swapchain::operator=(Swapchain&& other)
 {
-	this->~Swapchain();
+	Destroy();
 
 	m_Surface = other.m_Surface;
 	other.m_Surface = VK_NULL_HANDLE;
@@ -55,9 +59,13 @@ Swapchain& Swapchain::operator=(Swapchain&& other)
 	m_Format = other.m_Format;
 	m_Stalled = other.m_Stalled;
 	m_Size = other.m_Size;
+	m_FramebufferSize = other.m_FramebufferSize.load();
+	m_RecreatePending = other.m_RecreatePending.load();
+	m_Policy = other.m_Policy.load();
 
 	m_Images = std::move(other.m_Images);
 	m_Views = std::move(other.m_Views);
+	m_Retired = std::move(other.m_Retired);
 	m_PreResizeCallback = std::move(other.m_PreResizeCallback);
 	m_PostResizeCallback = std::move(other.m_PostResizeCallback);
 
@@ -68,7 +76,58 @@ void Swapchain::SetPreResizeCallback(std::function<void(u32, u32)> callback) { m
 
 void Swapchain::SetPostResizeCallback(std::function<void(u32, u32)> callback) { m_PostResizeCallback = callback; }
 
-std::optional<u32> Swapchain::GetNextImage(const Semaphore* semaphore, const Fence* fence, u64 timeout) const
+void Swapchain::SetPresentPolicy(PresentPolicy policy)
+{
+	if (m_Policy.exchange(policy) != policy)
+	{
+		m_RecreatePending = true;
+	}
+}
+
+bool Swapchain::ApplyChanges(u64 frame)
+{
+	if (!m_RecreatePending.exchange(false))
+	{
+		return false;
+	}
+
+	glm::u32vec2 size = m_FramebufferSize;
+	m_Stalled = size.x == 0 || size.y == 0;
+	if (m_Stalled)
+	{
+		return false;
+	}
+
+	if (m_PreResizeCallback)
+	{
+		m_PreResizeCallback(size.x, size.y);
+	}
+
+	Recreate(frame);
+
+	if (m_PostResizeCallback)
+	{
+		m_PostResizeCallback(size.x, size.y);
+	}
+
+	return true;
+}
+
+void Swapchain::ReleaseRetired(u64 completedFrames)
+{
+	std::erase_if(m_Retired, [completedFrames](RetiredSwapchain& retired) {
+		if (retired.Frame > completedFrames)
+		{
+			return false;
+		}
+
+		retired.Views.clear();
+		vkDestroySwapchainKHR(Instance::Device(), retired.Swapchain, nullptr);
+		return true;
+	});
+}
+
+std::optional<u32> Swapchain::GetNextImage(const Semaphore* semaphore, const Fence* fence, u64 timeout)
 {
 	if (m_Stalled)
 	{
@@ -79,62 +138,138 @@ std::optional<u32> Swapchain::GetNextImage(const Semaphore* semaphore, const Fen
 	VkResult res = vkAcquireNextImageKHR(Instance::Device(), m_Swapchain, timeout,
 		semaphore ? semaphore->GetHandle() : VK_NULL_HANDLE, fence ? fence->GetHandle() : VK_NULL_HANDLE, &ret);
 
-	if (res != VK_SUCCESS || ret == -1)
+	if (res == VK_ERROR_OUT_OF_DATE_KHR)
 	{
-		if (res != VK_ERROR_OUT_OF_DATE_KHR && res != VK_SUBOPTIMAL_KHR)
-		{
-			CRITICAL("Failed to acquire swapchain image");
-		}
-
+		m_RecreatePending = true;
 		return std::nullopt;
 	}
 
+	// The image is still acquired and the semaphore signaled when suboptimal, so it has to be used
+	if (res == VK_SUBOPTIMAL_KHR)
+	{
+		m_RecreatePending = true;
+	}
+	else if (res != VK_SUCCESS || ret == -1)
+	{
+		CRITICAL("Failed to acquire swapchain image");
+	}
+
 	return ret;
 }
 
-void Swapchain::Present(
-	std::span<const Swapchain*> swapchains, std::span<const Semaphore*> wait, std::span<u32> indices)
+bool Swapchain::Present(std::span<Swapchain*> swapchains, std::span<const Semaphore*> wait, std::span<u32> indices,
+	std::optional<u32> presentId)
 {
-	static std::vector<VkSemaphore> waitSemaphores;
-	static std::vector<VkSwapchainKHR> vkSwapchains;
-	static std::vector<VkResult> results;
+	ASSERT(swapchains.size() == indices.size(), "Presenting {} swapchains with {} image indices", swapchains.size(),
+		indices.size());
+
+	static thread_local std::vector<VkSemaphore> waitSemaphores;
+	static thread_local std::vector<Swapchain*> presented;
+	static thread_local std::vector<VkSwapchainKHR> vkSwapchains;
+	static thread_local std::vector<u32> vkIndices;
+	static thread_local std::vector<VkResult> results;
+	static thread_local std::vector<VkPresentTimeGOOGLE> times;
 
 	waitSemaphores.clear();
+	presented.clear();
 	vkSwapchains.clear();
-
-	waitSemaphores.reserve(wait.size());
-	vkSwapchains.reserve(swapchains.size());
-	results.resize(swapchains.size());
+	vkIndices.clear();
 
 	for (auto sem : wait)
 	{
 		waitSemaphores.push_back(sem->GetHandle());
 	}
-	for (auto swapchain : swapchains)
+
+	// Stalled swapchains drop out together with their index, so the rest still line up
+	for (u64 i = 0; i < swapchains.size(); i++)
 	{
-		if (!swapchain->m_Stalled)
+		if (!swapchains[i]->m_Stalled)
 		{
-			vkSwapchains.push_back(swapchain->m_Swapchain);
+			presented.push_back(swapchains[i]);
+			vkSwapchains.push_back(swapchains[i]->m_Swapchain);
+			vkIndices.push_back(indices[i]);
 		}
 	}
 
+	if (vkSwapchains.empty())
+	{
+		return false;
+	}
+	results.resize(vkSwapchains.size());
+
 	VkPresentInfoKHR info{ .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
 		.waitSemaphoreCount = u32(waitSemaphores.size()),
 		.pWaitSemaphores = waitSemaphores.data(),
 		.swapchainCount = u32(vkSwapchains.size()),
 		.pSwapchains = vkSwapchains.data(),
-		.pImageIndices = indices.data(),
+		.pImageIndices = vkIndices.data(),
 		.pResults = results.data() };
 
-	vkQueuePresentKHR(Instance::GraphicsQueue(), &info);
+	VkPresentTimesInfoGOOGLE timesInfo{ .sType = VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE };
+	if (presentId && Instance::Features().DisplayTiming)
+	{
+		times.assign(
+			vkSwapchains.size(), VkPresentTimeGOOGLE{ .presentID = presentId.value(), .desiredPresentTime = 0 });
+		timesInfo.swapchainCount = u32(times.size());
+		timesInfo.pTimes = times.data();
+		info.pNext = &timesInfo;
+	}
+
+	{
+		auto lock = Instance::LockQueue();
+		vkQueuePresentKHR(Instance::GraphicsQueue(), &info);
+	}
 
-	for (auto res : results)
+	bool outOfDate = false;
+	for (u64 i = 0; i < results.size(); i++)
 	{
-		if (res != VK_SUCCESS && res != VK_ERROR_OUT_OF_DATE_KHR && res != VK_SUBOPTIMAL_KHR)
+		if (results[i] == VK_ERROR_OUT_OF_DATE_KHR || results[i] == VK_SUBOPTIMAL_KHR)
+		{
+			presented[i]->m_RecreatePending = true;
+			outOfDate |= results[i] == VK_ERROR_OUT_OF_DATE_KHR;
+		}
+		else if (results[i] != VK_SUCCESS)
 		{
 			CRITICAL("Failed to present");
 		}
 	}
+
+	return outOfDate;
+}
+
+std::span<const PresentTiming> Swapchain::GetPresentTimings() const
+{
+	static thread_local std::vector<VkPastPresentationTimingGOOGLE> past;
+	static thread_local std::vector<PresentTiming> timings;
+
+	timings.clear();
+	if (!Instance::Features().DisplayTiming || m_Stalled)
+	{
+		return timings;
+	}
+
+	u32 count;
+	VkCall(vkGetPastPresentationTimingGOOGLE(Instance::Device(), m_Swapchain, &count, nullptr));
+	past.resize(count);
+	if (count == 0)
+	{
+		return timings;
+	}
+
+	// Anything that didn't fit is reported next time
+	VkResult res = vkGetPastPresentationTimingGOOGLE(Instance::Device(), m_Swapchain, &count, past.data());
+	if (res != VK_SUCCESS && res != VK_INCOMPLETE)
+	{
+		return timings;
+	}
+
+	timings.reserve(count);
+	for (u32 i = 0; i < count; i++)
+	{
+		timings.push_back(PresentTiming{ .PresentId = past[i].presentID, .ActualTime = past[i].actualPresentTime });
+	}
+
+	return timings;
 }
 
 struct Support
@@ -184,20 +319,72 @@ VkSurfaceFormatKHR GetFormat(const Support& support)
 	return support.Formats[0];
 }
 
-VkPresentModeKHR GetPresentMode(const Support& support)
+static bool HasPresentMode(const Support& support, VkPresentModeKHR mode)
 {
-	for (auto& mode : support.PresentModes)
+	return std::find(support.PresentModes.begin(), support.PresentModes.end(), mode) != support.PresentModes.end();
+}
+
+VkPresentModeKHR GetPresentMode(const Support& support, PresentPolicy policy)
+{
+	switch (policy)
 	{
-		if (mode == VK_PRESENT_MODE_MAILBOX_KHR)
+	case PresentPolicy::LowLatency:
+		if (HasPresentMode(support, VK_PRESENT_MODE_MAILBOX_KHR))
+		{
+			return VK_PRESENT_MODE_MAILBOX_KHR;
+		}
+		if (HasPresentMode(support, VK_PRESENT_MODE_IMMEDIATE_KHR))
 		{
-			return mode;
+			return VK_PRESENT_MODE_IMMEDIATE_KHR;
 		}
+		break;
+	case PresentPolicy::Balanced:
+		if (HasPresentMode(support, VK_PRESENT_MODE_MAILBOX_KHR))
+		{
+			return VK_PRESENT_MODE_MAILBOX_KHR;
+		}
+		break;
+	case PresentPolicy::PowerSaving: break;
 	}
 
 	return VK_PRESENT_MODE_FIFO_KHR;
 }
 
-VkExtent2D GetExtent(GLFWwindow* window, const Support& support)
+static const char* GetPresentModeName(VkPresentModeKHR mode)
+{
+	switch (mode)
+	{
+	case VK_PRESENT_MODE_IMMEDIATE_KHR: return "immediate";
+	case VK_PRESENT_MODE_MAILBOX_KHR: return "mailbox";
+	case VK_PRESENT_MODE_FIFO_KHR: return "FIFO";
+	case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "relaxed FIFO";
+	default: return "an unknown present mode";
+	}
+}
+
+u32 GetImageCount(const Support& support, PresentPolicy policy, VkPresentModeKHR mode)
+{
+	// Balanced keeps the two extra images swapchains always had. The other policies want as few frames queued up as
+	// possible, only mailbox needs one image more than the minimum to never block on acquire.
+	u32 count = support.Capabilities.minImageCount;
+	if (policy == PresentPolicy::Balanced)
+	{
+		count += 2;
+	}
+	else if (mode == VK_PRESENT_MODE_MAILBOX_KHR)
+	{
+		count++;
+	}
+
+	if (support.Capabilities.maxImageCount != 0 && count > support.Capabilities.maxImageCount)
+	{
+		count = support.Capabilities.maxImageCount;
+	}
+
+	return count;
+}
+
+VkExtent2D GetExtent(glm::u32vec2 size, const Support& support)
 {
 	if (support.Capabilities.currentExtent.width != -1)
 	{
@@ -205,20 +392,17 @@ VkExtent2D GetExtent(GLFWwindow* window, const Support& support)
 	}
 	else
 	{
-		int width, height;
-		glfwGetFramebufferSize(window, &width, &height);
-
 		VkExtent2D extent;
 		extent.width = std::clamp(
-			u32(width), support.Capabilities.minImageExtent.width, support.Capabilities.maxImageExtent.width);
+			size.x, support.Capabilities.minImageExtent.width, support.Capabilities.maxImageExtent.width);
 		extent.height = std::clamp(
-			u32(height), support.Capabilities.minImageExtent.height, support.Capabilities.maxImageExtent.height);
+			size.y, support.Capabilities.minImageExtent.height, support.Capabilities.maxImageExtent.height);
 
 		return extent;
 	}
 }
 
-Options GetSwapchainOptions(GLFWwindow* window, const Support& support)
+Options GetSwapchainOptions(glm::u32vec2 size, const Support& support, PresentPolicy policy)
 {
 	if (support.Formats.empty() || support.PresentModes.empty())
 	{
@@ -227,22 +411,17 @@ Options GetSwapchainOptions(GLFWwindow* window, const Support& support)
 
 	Options options{};
 	options.Format = GetFormat(support);
-	options.PresentMode = GetPresentMode(support);
-	options.Size = GetExtent(window, support);
-
-	options.ImageCount = support.Capabilities.minImageCount + 2;
-	if (support.Capabilities.maxImageCount != 0 && options.ImageCount > support.Capabilities.maxImageCount)
-	{
-		options.ImageCount = support.Capabilities.maxImageCount;
-	}
+	options.PresentMode = GetPresentMode(support, policy);
+	options.Size = GetExtent(size, support);
+	options.ImageCount = GetImageCount(support, policy, options.PresentMode);
 
 	return options;
 }
 
-void Swapchain::Recreate()
+void Swapchain::Recreate(u64 frame)
 {
 	auto support = GetSurfaceSupport(m_Surface);
-	auto options = GetSwapchainOptions(m_Window, support);
+	auto options = GetSwapchainOptions(m_FramebufferSize, support, m_Policy);
 	auto oldSwapchain = m_Swapchain;
 
 	m_Format = options.Format.format;
@@ -272,16 +451,26 @@ void Swapchain::Recreate()
 	}
 
 	VkCall(vkCreateSwapchainKHR(Instance::Device(), &info, nullptr, &m_Swapchain));
-	vkDestroySwapchainKHR(Instance::Device(), oldSwapchain, nullptr);
+
+	// Frames still in flight may render to or present the old images, so they stay around until those have completed
+	if (oldSwapchain != VK_NULL_HANDLE)
+	{
+		m_Retired.push_back(RetiredSwapchain{ .Swapchain = oldSwapchain, .Views = std::move(m_Views), .Frame = frame });
+	}
 
 	u32 count;
 	VkCall(vkGetSwapchainImagesKHR(Instance::Device(), m_Swapchain, &count, nullptr));
-	m_Images.resize(count);
-	VkCall(vkGetSwapchainImagesKHR(Instance::Device(), m_Swapchain, &count, m_Images.data()));
+	std::vector<VkImage> images(count);
+	VkCall(vkGetSwapchainImagesKHR(Instance::Device(), m_Swapchain, &count, images.data()));
+	m_Images.clear();
+	m_Images.reserve(count);
+	m_Views.clear();
 	m_Views.resize(count);
 
-	for (u64 i = 0; auto image : m_Images)
+	for (u64 i = 0; auto image : images)
 	{
+		m_Images.push_back(Image(image));
+
 		m_Views[i] = ImageView(image, options.Format.format, VK_IMAGE_VIEW_TYPE_2D,
 			VkComponentMapping{ .r = VK_COMPONENT_SWIZZLE_IDENTITY,
 				.g = VK_COMPONENT_SWIZZLE_IDENTITY,
@@ -295,25 +484,30 @@ void Swapchain::Recreate()
 
 		i++;
 	}
+
+	DEBUG("Swapchain has {} images and presents with {}", count, GetPresentModeName(options.PresentMode));
 }
 
-void Swapchain::FramebufferResizeCallback(GLFWwindow* window, int width, int height)
+void Swapchain::Destroy()
 {
-	auto& swapchain = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window))->m_Swapchain;
-	swapchain.m_Stalled = width == 0 || height == 0;
-
-	if (!swapchain.m_Stalled)
+	for (auto& retired : m_Retired)
 	{
-		if (swapchain.m_PreResizeCallback)
-		{
-			swapchain.m_PreResizeCallback(width, height);
-		}
+		retired.Views.clear();
+		vkDestroySwapchainKHR(Instance::Device(), retired.Swapchain, nullptr);
+	}
+	m_Retired.clear();
 
-		swapchain.Recreate();
+	m_Views.clear();
+	m_Images.clear();
+	vkDestroySwapchainKHR(Instance::Device(), m_Swapchain, nullptr);
+	vkDestroySurfaceKHR(Instance::Instance(), m_Surface, nullptr);
+}
 
-		if (swapchain.m_PostResizeCallback)
-		{
-			swapchain.m_PostResizeCallback(width, height);
-		}
-	}
+void Swapchain::FramebufferResizeCallback(GLFWwindow* window, int width, int height)
+{
+	// Runs inside event polling, so the swapchain is only recreated once the presenting thread gets to it
+	auto& owindow = *reinterpret_cast<Window*>(glfwGetWindowUserPointer(window));
+	owindow.m_Swapchain.m_FramebufferSize = glm::u32vec2(width, height);
+	owindow.m_Swapchain.m_RecreatePending = true;
+	owindow.m_Damaged = true;
 }
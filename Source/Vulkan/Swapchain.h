@@ -6,6 +6,23 @@
 class Semaphore;
 class Fence;
 
+enum class PresentPolicy
+{
+	// Mailbox, or immediate if that isn't available, with as few images as possible
+	LowLatency,
+	// Mailbox if available, with two extra images so rendering doesn't wait on the display
+	Balanced,
+	// FIFO with as few images as possible, so the GPU idles once it is a frame ahead
+	PowerSaving
+};
+
+struct PresentTiming
+{
+	u32 PresentId;
+	// When the image started showing on the display, in nanoseconds of the monotonic clock
+	u64 ActualTime;
+};
+
 class Swapchain
 {
 public:
@@ -23,16 +40,45 @@ public:
 	void SetPostResizeCallback(std::function<void(u32, u32)> callback);
 
 	VkFormat GetFormat() const { return m_Format; }
+	const std::vector<Image>& GetImages() const { return m_Images; }
 	const std::vector<ImageView>& GetViews() const { return m_Views; }
 	glm::u32vec2 GetSize() const { return m_Size; }
+	// Nothing can be presented while the window has no area, e.g. while minimized
+	bool IsStalled() const { return m_Stalled; }
+
+	// Can be called from any thread, the swapchain is recreated with the new policy on the next ApplyChanges
+	void SetPresentPolicy(PresentPolicy policy);
+	PresentPolicy GetPresentPolicy() const { return m_Policy; }
+
+	// Recreates the swapchain if the window was resized or the policy changed since the last call, running the resize
+	// callbacks. Changes are only recorded by the callers, so this has to be called by the thread that presents.
+	// Frames before the given one may still use the old images, so they are only retired instead of destroyed.
+	bool ApplyChanges(u64 frame);
+	// Destroys retired swapchains whose frames have all completed
+	void ReleaseRetired(u64 completedFrames);
 
-	std::optional<u32> GetNextImage(const Semaphore* semaphore, const Fence* fence, u64 timeout = -1) const;
-	static void Present(std::span<const Swapchain*> swapchains, std::span<const Semaphore*> wait, std::span<u32> indices);
+	std::optional<u32> GetNextImage(const Semaphore* semaphore, const Fence* fence, u64 timeout = -1);
+	// Presents every swapchain in one call, skipping the stalled ones. The present ID is reported back with the display
+	// time, if the device supports display timing. Returns whether any image was dropped as its swapchain was out of
+	// date, the window then has to be drawn again once the swapchain is recreated.
+	static bool Present(std::span<Swapchain*> swapchains, std::span<const Semaphore*> wait, std::span<u32> indices,
+		std::optional<u32> presentId = std::nullopt);
+
+	// Presents the display engine has reported on since the last call. Always empty without display timing.
+	std::span<const PresentTiming> GetPresentTimings() const;
 
 private:
 	static void FramebufferResizeCallback(GLFWwindow* window, int width, int height);
 
-	void Recreate();
+	struct RetiredSwapchain
+	{
+		VkSwapchainKHR Swapchain;
+		std::vector<ImageView> Views;
+		u64 Frame;
+	};
+
+	void Recreate(u64 frame);
+	void Destroy();
 
 	GLFWwindow* m_Window = nullptr;
 	VkSurfaceKHR m_Surface = VK_NULL_HANDLE;
@@ -40,11 +86,15 @@ private:
 
 	VkFormat m_Format;
 
-	std::vector<VkImage> m_Images;
+	std::vector<Image> m_Images;
 	std::vector<ImageView> m_Views;
+	std::vector<RetiredSwapchain> m_Retired;
 	bool m_Stalled = false;
 
 	glm::u32vec2 m_Size;
+	std::atomic<glm::u32vec2> m_FramebufferSize;
+	std::atomic<bool> m_RecreatePending = false;
+	std::atomic<PresentPolicy> m_Policy = PresentPolicy::Balanced;
 	std::function<void(u32, u32)> m_PreResizeCallback;
 	std::function<void(u32, u32)> m_PostResizeCallback;
 };
@@ -9,7 +9,7 @@ Semaphore::Semaphore()
 	VkCall(vkCreateSemaphore(Instance::Device(), &info, nullptr, &m_Semaphore));
 }
 
-Semaphore::~Semaphore() { vkDestroySemaphore(Instance::Device(), m_Semaphore, nullptr); }
+Semaphore::~Semaphore() { Destroy(); }
 
 Semaphore::Semaphore(Semaphore&& other)
 {
@@ -19,7 +19,7 @@ Semaphore::Semaphore(Semaphore&& other)
 
 Semaphore& Semaphore::operator=(Semaphore&& other)
 {
-	this->~Semaphore();
+	Destroy();
 
 	m_Semaphore = other.m_Semaphore;
 	other.m_Semaphore = VK_NULL_HANDLE;
@@ -27,6 +27,8 @@ Semaphore& Semaphore::operator=(Semaphore&& other)
 	return *this;
 }
 
+void Semaphore::Destroy() { vkDestroySemaphore(Instance::Device(), m_Semaphore, nullptr); }
+
 Fence::Fence(VkFenceCreateFlags flags)
 {
 	VkFenceCreateInfo info{ .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, .flags = flags };
@@ -34,7 +36,7 @@ Fence::Fence(VkFenceCreateFlags flags)
 	VkCall(vkCreateFence(Instance::Device(), &info, nullptr, &m_Fence));
 }
 
-Fence::~Fence() { vkDestroyFence(Instance::Device(), m_Fence, nullptr); }
+Fence::~Fence() { Destroy(); }
 
 Fence::Fence(Fence&& other)
 {
@@ -44,7 +46,7 @@ Fence::Fence(Fence&& other)
 
 Fence& Fence::operator=(Fence&& other)
 {
-	this->~Fence();
+	Destroy();
 
 	m_Fence = other.m_Fence;
 	other.m_Fence = VK_NULL_HANDLE;
@@ -52,9 +54,45 @@ Fence& Fence::operator=(Fence&& other)
 	return *this;
 }
 
+void Fence::Destroy() { vkDestroyFence(Instance::Device(), m_Fence, nullptr); }
+
 bool Fence::WaitOn(u64 timeout)
 {
 	return vkWaitForFences(Instance::Device(), 1, &m_Fence, VK_TRUE, timeout) == VK_SUCCESS;
 }
 
 void Fence::Reset() { vkResetFences(Instance::Device(), 1, &m_Fence); }
+
+GpuEvent::GpuEvent()
+{
+	VkEventCreateInfo info{ .sType = VK_STRUCTURE_TYPE_EVENT_CREATE_INFO,
+		.flags = Instance::Features().Synchronization2 ? VK_EVENT_CREATE_DEVICE_ONLY_BIT_KHR : 0u };
+
+	VkCall(vkCreateEvent(Instance::Device(), &info, nullptr, &m_Event));
+}
+
+GpuEvent::~GpuEvent() { Destroy(); }
+
+GpuEvent::GpuEvent(GpuEvent&& other)
+{
+	m_Event = other.m_Event;
+	other.m_Event = VK_NULL_HANDLE;
+	m_Memory = std::move(other.m_Memory);
+	m_Buffers = std::move(other.m_Buffers);
+	m_Images = std::move(other.m_Images);
+}
+
+GpuEvent& GpuEvent::operator=(GpuEvent&& other)
+{
+	Destroy();
+
+	m_Event = other.m_Event;
+	other.m_Event = VK_NULL_HANDLE;
+	m_Memory = std::move(other.m_Memory);
+	m_Buffers = std::move(other.m_Buffers);
+	m_Images = std::move(other.m_Images);
+
+	return *this;
+}
+
+void GpuEvent::Destroy() { vkDestroyEvent(Instance::Device(), m_Event, nullptr); }
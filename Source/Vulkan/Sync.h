@@ -17,6 +17,8 @@ public:
 	VkSemaphore GetHandle() const { return m_Semaphore; }
 
 private:
+	void Destroy();
+
 	VkSemaphore m_Semaphore = VK_NULL_HANDLE;
 };
 
@@ -38,5 +40,34 @@ public:
 	void Reset();
 
 private:
+	void Destroy();
+
 	VkFence m_Fence = VK_NULL_HANDLE;
 };
+
+// Splits a barrier in two, so unrelated work recorded between the signal and the wait can overlap with it
+class GpuEvent
+{
+public:
+	GpuEvent();
+	~GpuEvent();
+
+	GpuEvent(const GpuEvent& other) = delete;
+	GpuEvent& operator=(const GpuEvent& other) = delete;
+
+	GpuEvent(GpuEvent&& other);
+	GpuEvent& operator=(GpuEvent&& other);
+
+	VkEvent GetHandle() const { return m_Event; }
+
+private:
+	friend class CommandBuffer;
+
+	void Destroy();
+
+	VkEvent m_Event = VK_NULL_HANDLE;
+	// The barriers of the last signal, as the wait has to use the same ones
+	std::vector<VkMemoryBarrier2KHR> m_Memory;
+	std::vector<VkBufferMemoryBarrier2KHR> m_Buffers;
+	std::vector<VkImageMemoryBarrier2KHR> m_Images;
+};
@@ -8,90 +8,37 @@ void Input::KeyCallback(GLFWwindow* window, int key, int scancode, int action, i
 {
 	auto& input = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window))->m_Input;
 
-	switch (action)
+	if (key == GLFW_KEY_UNKNOWN || action == GLFW_REPEAT)
 	{
-	case GLFW_PRESS:
-		input.m_KeyStates[key] = true;
-		if (input.m_KeyboardCaptured) { return; }
-		for (auto& call : input.m_KeyCallbacks)
-		{
-			call(Key(key), true);
-		}
-		break;
-	case GLFW_RELEASE:
-		input.m_KeyStates[key] = false;
-		if (input.m_KeyboardCaptured) { return; }
-		for (auto& call : input.m_KeyCallbacks)
-		{
-			call(Key(key), false);
-		}
-		break;
-	default: break;
+		return;
 	}
+
+	input.Push(InputEvent{ .EventType = InputEvent::Type::Key, .Pressed = action == GLFW_PRESS, .EventKey = Key(key) });
 }
 
 void Input::CharCallback(GLFWwindow* window, u32 codepoint)
 {
 	auto& input = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window))->m_Input;
-
-	if (input.m_KeyboardCaptured) { return; }
-	for (auto& call : input.m_CharCallbacks)
-	{
-		call(codepoint);
-	}
+	input.Push(InputEvent{ .EventType = InputEvent::Type::Char, .Codepoint = codepoint });
 }
 
 void Input::CursorCallback(GLFWwindow* window, double x, double y)
 {
 	auto& input = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window))->m_Input;
-	input.m_MouseState.Position.x = int32_t(x);
-	input.m_MouseState.Position.y = int32_t(y);
-
-	if (input.m_MouseCaptured) { return; }
-	for (auto& call : input.m_MoveCallbacks)
-	{
-		call(input.m_MouseState.Position);
-	}
+	input.Push(InputEvent{ .EventType = InputEvent::Type::Move, .Value = { float(x), float(y) } });
 }
 
 void Input::ButtonCallback(GLFWwindow* window, int button, int action, int mods)
 {
 	auto& input = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window))->m_Input;
-	switch (action)
-	{
-	case GLFW_PRESS:
-		input.m_MouseState.Buttons[button] = true;
-
-		if (input.m_MouseCaptured) { return; }
-		for (auto& call : input.m_ButtonCallbacks)
-		{
-			call(button, true);
-		}
-		break;
-	case GLFW_RELEASE:
-		input.m_MouseState.Buttons[button] = false;
-
-		if (input.m_MouseCaptured) { return; }
-		for (auto& call : input.m_ButtonCallbacks)
-		{
-			call(button, false);
-		}
-		break;
-	default: break;
-	}
+	input.Push(
+		InputEvent{ .EventType = InputEvent::Type::Button, .Pressed = action == GLFW_PRESS, .Button = i8(button) });
 }
 
 void Input::ScrollCallback(GLFWwindow* window, double x, double y)
 {
 	auto& input = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window))->m_Input;
-	input.m_MouseState.WheelPos.x += float(x);
-	input.m_MouseState.WheelPos.y += float(y);
-
-	if (input.m_MouseCaptured) { return; }
-	for (auto& call : input.m_ScrollCallbacks)
-	{
-		call({ float(x), float(y) });
-	}
+	input.Push(InputEvent{ .EventType = InputEvent::Type::Scroll, .Value = { float(x), float(y) } });
 }
 
 void Input::SetupCallbacks(GLFWwindow* window) 
@@ -103,6 +50,29 @@ void Input::SetupCallbacks(GLFWwindow* window)
 	glfwSetScrollCallback(window, Input::ScrollCallback);
 }
 
+void Input::Update()
+{
+	m_Snapshot.Pressed.reset();
+	m_Snapshot.Released.reset();
+	m_Snapshot.Scroll = { 0.f, 0.f };
+	m_Snapshot.Time = std::chrono::steady_clock::now();
+	m_Snapshot.OldestEvent.reset();
+
+	// Only drains what was there when the frame started, so a flood of events can't hold the frame up
+	for (u64 count = m_Events->GetSize(); count > 0; count--)
+	{
+		InputEvent& event = m_Events->Peek();
+		m_Snapshot.LastEvent = event.Id;
+		if (!m_Snapshot.OldestEvent)
+		{
+			m_Snapshot.OldestEvent = event.Time;
+		}
+
+		Dispatch(event);
+		m_Events->Release();
+	}
+}
+
 const char* Input::GetClipboardData()
 {
 	return glfwGetClipboardString(nullptr);
@@ -112,3 +82,74 @@ void Input::SetClipboardData(const char* data)
 {
 	glfwSetClipboardString(nullptr, data);
 }
+
+void Input::Push(InputEvent event)
+{
+	event.Id = m_NextEventId++;
+	event.Time = std::chrono::steady_clock::now();
+
+	// Dropping is better than blocking the event thread, but should never happen with a frame's worth of input
+	if (!m_Events->TryPush(event))
+	{
+		if (!m_Overflowing)
+		{
+			WARN("Input queue is full, dropping events");
+		}
+		m_Overflowing = true;
+		return;
+	}
+
+	m_Overflowing = false;
+}
+
+void Input::Dispatch(const InputEvent& event)
+{
+	switch (event.EventType)
+	{
+	case InputEvent::Type::Key:
+		m_Snapshot.Keys[u32(event.EventKey)] = event.Pressed;
+		(event.Pressed ? m_Snapshot.Pressed : m_Snapshot.Released)[u32(event.EventKey)] = true;
+
+		if (m_KeyboardCaptured) { return; }
+		for (auto& call : m_KeyCallbacks)
+		{
+			call(event.EventKey, event.Pressed);
+		}
+		break;
+	case InputEvent::Type::Char:
+		if (m_KeyboardCaptured) { return; }
+		for (auto& call : m_CharCallbacks)
+		{
+			call(event.Codepoint);
+		}
+		break;
+	case InputEvent::Type::Button:
+		m_Snapshot.Mouse.Buttons[event.Button] = event.Pressed;
+
+		if (m_MouseCaptured) { return; }
+		for (auto& call : m_ButtonCallbacks)
+		{
+			call(event.Button, event.Pressed);
+		}
+		break;
+	case InputEvent::Type::Move:
+		m_Snapshot.Mouse.Position = glm::i32vec2(event.Value);
+
+		if (m_MouseCaptured) { return; }
+		for (auto& call : m_MoveCallbacks)
+		{
+			call(m_Snapshot.Mouse.Position);
+		}
+		break;
+	case InputEvent::Type::Scroll:
+		m_Snapshot.Mouse.WheelPos += event.Value;
+		m_Snapshot.Scroll += event.Value;
+
+		if (m_MouseCaptured) { return; }
+		for (auto& call : m_ScrollCallbacks)
+		{
+			call(event.Value);
+		}
+		break;
+	}
+}
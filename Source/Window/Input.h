@@ -2,6 +2,7 @@
 
 #include "GLFW/glfw3.h"
 
+#include "Core/RingBuffer.h"
 #include "Key.h"
 
 struct MouseState
@@ -11,16 +12,57 @@ struct MouseState
 	glm::vec2 WheelPos = { 0.f, 0.f };
 };
 
+struct InputEvent
+{
+	enum class Type : u8
+	{
+		Key, Char, Button, Move, Scroll
+	};
+
+	Type EventType;
+	bool Pressed;
+	Key EventKey;
+	i8 Button;
+	u32 Codepoint;
+	glm::vec2 Value;
+
+	// Set when queued, so they follow the event through the frames it affects
+	u64 Id;
+	std::chrono::steady_clock::time_point Time;
+};
+
+// Everything that happened to the input since the previous Update
+struct InputSnapshot
+{
+	std::bitset<GLFW_KEY_LAST + 1> Keys;
+	std::bitset<GLFW_KEY_LAST + 1> Pressed;
+	std::bitset<GLFW_KEY_LAST + 1> Released;
+	MouseState Mouse;
+	glm::vec2 Scroll = { 0.f, 0.f };
+	std::chrono::steady_clock::time_point Time;
+
+	// The newest event handled so far, and when the oldest one handled this update happened
+	u64 LastEvent = 0;
+	std::optional<std::chrono::steady_clock::time_point> OldestEvent;
+};
+
+// The window callbacks only timestamp events and push them into a queue. Update drains it once per frame on the
+// simulation thread, which is where the snapshot changes and the event callbacks run.
 class Input
 {
 public:
 	void SetupCallbacks(GLFWwindow* window);
 
+	void Update();
+
 	static const char* GetClipboardData();
 	static void SetClipboardData(const char* data);
 
-	const MouseState& GetMouseState() const { return m_MouseState; }
-	bool IsKeyDown(Key key) const { return m_KeyStates[u32(key)]; }
+	const InputSnapshot& GetSnapshot() const { return m_Snapshot; }
+	const MouseState& GetMouseState() const { return m_Snapshot.Mouse; }
+	bool IsKeyDown(Key key) const { return m_Snapshot.Keys[u32(key)]; }
+	bool WasKeyPressed(Key key) const { return m_Snapshot.Pressed[u32(key)]; }
+	bool WasKeyReleased(Key key) const { return m_Snapshot.Released[u32(key)]; }
 
 	template<typename Callable>
 	void AddKeyEvent(const Callable& function)
@@ -62,8 +104,14 @@ private:
 	static void ButtonCallback(GLFWwindow* window, int button, int action, int mods);
 	static void ScrollCallback(GLFWwindow* window, double x, double y);
 
-	std::bitset<GLFW_KEY_LAST + 1> m_KeyStates;
-	MouseState m_MouseState;
+	void Push(InputEvent event);
+	void Dispatch(const InputEvent& event);
+
+	// Allocated, so Input stays movable
+	std::unique_ptr<RingBuffer<InputEvent, 1024>> m_Events = std::make_unique<RingBuffer<InputEvent, 1024>>();
+	bool m_Overflowing = false;
+	u64 m_NextEventId = 1;
+	InputSnapshot m_Snapshot;
 
 	std::vector<std::function<void(Key, bool)>> m_KeyCallbacks;
 	std::vector<std::function<void(u32)>> m_CharCallbacks;
@@ -28,6 +28,10 @@ Window::Window(const char* title, glm::u32vec2 dimensions, Style style)
 
 	glfwSetWindowUserPointer(m_Window, this);
 	glfwSetWindowRefreshCallback(m_Window, &Window::WindowRefreshCallback);
+	glfwSetWindowFocusCallback(m_Window, &Window::WindowFocusCallback);
+	glfwSetWindowIconifyCallback(m_Window, &Window::WindowIconifyCallback);
+	m_Focused = glfwGetWindowAttrib(m_Window, GLFW_FOCUSED);
+	m_Minimized = glfwGetWindowAttrib(m_Window, GLFW_ICONIFIED);
 	m_Input.SetupCallbacks(m_Window);
 
 	TRACE("Create window '{}'", title);
@@ -35,10 +39,7 @@ Window::Window(const char* title, glm::u32vec2 dimensions, Style style)
 	m_Swapchain = Swapchain(m_Window);
 }
 
-Window::~Window() 
-{ 
-	glfwDestroyWindow(m_Window); 
-}
+Window::~Window() { Destroy(); }
 
 Window::Window(Window&& other) noexcept
 {
@@ -46,24 +47,38 @@ Window::Window(Window&& other) noexcept
 	other.m_Window = nullptr;
 	m_Input = std::move(other.m_Input);
 	m_Swapchain = std::move(other.m_Swapchain);
+	m_Focused = other.m_Focused;
+	m_Minimized = other.m_Minimized;
+	m_Hidden = other.m_Hidden.load();
+	m_Damaged = other.m_Damaged;
 	glfwSetWindowUserPointer(m_Window, this);
 }
 
 Window& Window::operator=(Window&& other) noexcept
 {
-	this->~Window();
+	Destroy();
 
 	m_Window = other.m_Window;
 	other.m_Window = nullptr;
 	m_Input = std::move(other.m_Input);
 	m_Swapchain = std::move(other.m_Swapchain);
+	m_Focused = other.m_Focused;
+	m_Minimized = other.m_Minimized;
+	m_Hidden = other.m_Hidden.load();
+	m_Damaged = other.m_Damaged;
 	glfwSetWindowUserPointer(m_Window, this);
 
 	return *this;
 }
 
+void Window::Destroy() { glfwDestroyWindow(m_Window); }
+
 void Window::PollEvents() { glfwPollEvents(); }
 
+void Window::WaitEvents(f64 timeout) { glfwWaitEventsTimeout(timeout); }
+
+void Window::PostEmptyEvent() { glfwPostEmptyEvent(); }
+
 void Window::Init()
 {
 	glfwInit();
@@ -75,6 +90,15 @@ void Window::Cleanup() { glfwTerminate(); }
 
 bool Window::ShouldClose() { return glfwWindowShouldClose(m_Window); }
 
+void Window::Hide()
+{
+	glfwSetWindowShouldClose(m_Window, GLFW_FALSE);
+	glfwHideWindow(m_Window);
+	m_Hidden = true;
+}
+
+bool Window::ConsumeDamage() { return std::exchange(m_Damaged, false); }
+
 void Window::SetRedrawCallback(std::function<void()> callback) { m_RedrawCallback = callback; }
 
 void Window::WindowRefreshCallback(GLFWwindow* window) 
@@ -86,3 +110,16 @@ void Window::WindowRefreshCallback(GLFWwindow* window)
 		owindow.m_RedrawCallback();
 	}
 }
+
+void Window::WindowFocusCallback(GLFWwindow* window, int focused)
+{
+	auto& owindow = *reinterpret_cast<Window*>(glfwGetWindowUserPointer(window));
+	owindow.m_Focused = focused == GLFW_TRUE;
+}
+
+void Window::WindowIconifyCallback(GLFWwindow* window, int iconified)
+{
+	auto& owindow = *reinterpret_cast<Window*>(glfwGetWindowUserPointer(window));
+	owindow.m_Minimized = iconified == GLFW_TRUE;
+	owindow.m_Damaged = true;
+}
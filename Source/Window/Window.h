@@ -22,13 +22,26 @@ public:
 	Window& operator=(Window&& other) noexcept;
 
 	static void PollEvents();
+	// Sleeps until an event arrives or the timeout in seconds runs out
+	static void WaitEvents(f64 timeout);
+	// Wakes up WaitEvents, can be called from any thread
+	static void PostEmptyEvent();
 
 	static void Init();
 	static void Cleanup();
 
 	bool ShouldClose();
+	bool IsFocused() const { return m_Focused; }
+	bool IsMinimized() const { return m_Minimized; }
+	// Hidden windows stay alive but aren't presented to, can be checked from any thread
+	bool IsHidden() const { return m_Hidden; }
+	// Also clears the close flag, so a closed window can be hidden instead of destroyed
+	void Hide();
 
-	const Input& GetInput() { return m_Input; }
+	// Whether the contents have to be drawn again because the window changed, clears it
+	bool ConsumeDamage();
+
+	Input& GetInput() { return m_Input; }
 	Swapchain& GetSwapchain() { return m_Swapchain; }
 
 	void SetRedrawCallback(std::function<void()> callback);
@@ -37,10 +50,19 @@ private:
 	friend class Input;
 	friend class Swapchain;
 
+	void Destroy();
+
 	static void WindowRefreshCallback(GLFWwindow* window);
+	static void WindowFocusCallback(GLFWwindow* window, int focused);
+	static void WindowIconifyCallback(GLFWwindow* window, int iconified);
 
 	GLFWwindow* m_Window = nullptr;
 	Input m_Input;
 	Swapchain m_Swapchain;
 	std::function<void()> m_RedrawCallback;
+
+	bool m_Focused = false;
+	bool m_Minimized = false;
+	std::atomic<bool> m_Hidden = false;
+	bool m_Damaged = true;
 };
@@ -0,0 +1,130 @@
+#include "PCH.h"
+
+#include "WindowManager.h"
+
+Window& WindowManager::Create(const char* title, glm::u32vec2 dimensions, Window::Style style)
+{
+	m_Windows.push_back(Entry{ std::make_unique<Window>(title, dimensions, style), Semaphore() });
+	return *m_Windows.back().Target;
+}
+
+bool WindowManager::ShouldClose()
+{
+	if (m_Windows.empty() || m_Windows.front().Target->ShouldClose())
+	{
+		return true;
+	}
+
+	for (u32 i = 1; i < m_Windows.size(); i++)
+	{
+		Window& window = *m_Windows[i].Target;
+		if (window.ShouldClose())
+		{
+			window.Hide();
+		}
+	}
+
+	return false;
+}
+
+bool WindowManager::IsFocused() const
+{
+	return std::any_of(
+		m_Windows.begin(), m_Windows.end(), [](const Entry& entry) { return entry.Target->IsFocused(); });
+}
+
+bool WindowManager::IsMinimized() const
+{
+	return std::all_of(
+		m_Windows.begin(), m_Windows.end(), [](const Entry& entry) {
+			return entry.Target->IsMinimized() || entry.Target->IsHidden();
+		});
+}
+
+bool WindowManager::UpdateInput()
+{
+	bool handled = false;
+	for (auto& entry : m_Windows)
+	{
+		Input& input = entry.Target->GetInput();
+		input.Update();
+		handled |= input.GetSnapshot().OldestEvent.has_value();
+	}
+
+	return handled;
+}
+
+bool WindowManager::ConsumeDamage()
+{
+	// Every window has to be cleared, so no short circuiting
+	bool damaged = false;
+	for (auto& entry : m_Windows)
+	{
+		damaged |= entry.Target->ConsumeDamage();
+	}
+
+	return damaged;
+}
+
+void WindowManager::ApplyChanges(u64 frame)
+{
+	for (auto& entry : m_Windows)
+	{
+		entry.Target->GetSwapchain().ApplyChanges(frame);
+	}
+}
+
+void WindowManager::ReleaseRetired(u64 completedFrames)
+{
+	for (auto& entry : m_Windows)
+	{
+		entry.Target->GetSwapchain().ReleaseRetired(completedFrames);
+	}
+}
+
+std::span<const WindowManager::AcquiredImage> WindowManager::Acquire()
+{
+	m_Acquired.clear();
+	m_Waits.clear();
+	m_AcquireIncomplete = false;
+
+	for (u32 i = 0; i < m_Windows.size(); i++)
+	{
+		Entry& entry = m_Windows[i];
+		if (entry.Target->IsHidden())
+		{
+			continue;
+		}
+
+		Swapchain& swapchain = entry.Target->GetSwapchain();
+		if (std::optional<u32> image = swapchain.GetNextImage(&entry.ImageAvailable, nullptr))
+		{
+			m_Acquired.push_back(AcquiredImage{ .WindowIndex = i, .Image = image.value() });
+			m_Waits.emplace_back(&entry.ImageAvailable, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+		}
+		else if (!swapchain.IsStalled())
+		{
+			m_AcquireIncomplete = true;
+		}
+	}
+
+	return m_Acquired;
+}
+
+bool WindowManager::Present(std::optional<u32> presentId)
+{
+	m_Swapchains.clear();
+	m_Indices.clear();
+
+	for (auto& acquired : m_Acquired)
+	{
+		m_Swapchains.push_back(&m_Windows[acquired.WindowIndex].Target->GetSwapchain());
+		m_Indices.push_back(acquired.Image);
+	}
+
+	const Semaphore* wait[] = { &m_RenderFinished };
+	bool outOfDate = Swapchain::Present(m_Swapchains, wait, m_Indices, presentId);
+	m_Acquired.clear();
+
+	return outOfDate;
+}
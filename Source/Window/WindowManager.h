@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Window.h"
+#include "Vulkan/Sync.h"
+
+// Owns every window the app renders to. All of them are acquired, submitted and presented together, so an extra window
+// only costs its own commands instead of another submit and present.
+class WindowManager
+{
+public:
+	struct AcquiredImage
+	{
+		u32 WindowIndex;
+		u32 Image;
+	};
+
+	// Windows can't be added while the render thread uses the manager
+	Window& Create(const char* title, glm::u32vec2 dimensions, Window::Style style = Window::Style::Default);
+
+	u32 GetCount() const { return u32(m_Windows.size()); }
+	Window& Get(u32 index) { return *m_Windows[index].Target; }
+
+	// The first window is the main one, closing it closes all of them. The others are only hidden when closed, as the
+	// render thread may still be presenting to them.
+	bool ShouldClose();
+	// Whether any window is focused, and whether all visible ones are minimized
+	bool IsFocused() const;
+	bool IsMinimized() const;
+
+	// Returns whether any window had input to handle
+	bool UpdateInput();
+	// Whether any window has to be drawn again because it changed, clears it
+	bool ConsumeDamage();
+
+	// Everything below is for the render thread only
+	void ApplyChanges(u64 frame);
+	void ReleaseRetired(u64 completedFrames);
+
+	// Acquires an image from every window that can present right now. The submit using them has to wait on GetWaits
+	// and signal GetRenderFinished, then Present hands all the images back in one call.
+	std::span<const AcquiredImage> Acquire();
+	// Whether the last Acquire skipped a window that needs another try, like one whose swapchain went out of date
+	bool IsAcquireIncomplete() const { return m_AcquireIncomplete; }
+	std::span<std::pair<const Semaphore*, VkPipelineStageFlags>> GetWaits() { return m_Waits; }
+	const Semaphore& GetRenderFinished() const { return m_RenderFinished; }
+	// Returns whether a window has to be drawn again, as its image was dropped
+	bool Present(std::optional<u32> presentId = std::nullopt);
+
+private:
+	struct Entry
+	{
+		// Behind a pointer, as GLFW keeps a pointer to the window
+		std::unique_ptr<Window> Target;
+		// The submit waits on all acquires at once, so each needs its own semaphore
+		Semaphore ImageAvailable;
+	};
+
+	std::vector<Entry> m_Windows;
+	Semaphore m_RenderFinished;
+
+	std::vector<AcquiredImage> m_Acquired;
+	bool m_AcquireIncomplete = false;
+	std::vector<std::pair<const Semaphore*, VkPipelineStageFlags>> m_Waits;
+	std::vector<Swapchain*> m_Swapchains;
+	std::vector<u32> m_Indices;
+};
@@ -0,0 +1,144 @@
+#include "PCH.h"
+
+#include "App/TelemetryFormat.h"
+
+#include <cstdio>
+
+// Converts the telemetry ring file to CSV on stdout. With --follow it keeps tailing the file while the app writes to
+// it, using the pass names known when it started.
+
+static bool ReadHeader(std::ifstream& file, Telemetry::FileHeader& header)
+{
+	file.clear();
+	file.seekg(0);
+	return bool(file.read(reinterpret_cast<char*>(&header), sizeof(header)));
+}
+
+static bool ReadRecord(
+	std::ifstream& file, const Telemetry::FileHeader& header, u64 index, Telemetry::FrameRecord& record)
+{
+	file.clear();
+	file.seekg(sizeof(Telemetry::FileHeader) + (index % header.Capacity) * sizeof(Telemetry::FrameRecord));
+	return bool(file.read(reinterpret_cast<char*>(&record), sizeof(record)));
+}
+
+static void PrintHeader(const Telemetry::FileHeader& header)
+{
+	std::printf("frame,present_time_ns");
+	for (const char* stage : Telemetry::StageNames)
+	{
+		std::printf(",cpu_%s_ms", stage);
+	}
+	for (u32 i = 0; i < header.PassCount; i++)
+	{
+		std::printf(",gpu_%.*s_ms", int(Telemetry::MaxPassName), header.PassNames[i]);
+	}
+	std::printf(",objects,draws,dispatches,pipeline_binds,descriptor_binds,barriers,copies,input_to_present_ms"
+		",windows_presented,vertices,triangles,memory_usage,memory_budget,gpu_input_vertices,gpu_input_primitives"
+		",gpu_vertex_invocations,gpu_clipping_primitives,gpu_fragment_invocations,gpu_compute_invocations\n");
+}
+
+static void PrintRecord(const Telemetry::FrameRecord& record, u32 passCount)
+{
+	std::printf("%llu,%llu", (unsigned long long)record.Frame, (unsigned long long)record.PresentTime);
+	for (f32 time : record.CpuTime)
+	{
+		std::printf(",%.4f", time);
+	}
+	for (u32 i = 0; i < passCount; i++)
+	{
+		std::printf(",%.4f", record.GpuTime[i]);
+	}
+	std::printf(",%u,%u,%u,%u,%u,%u,%u,%.4f,%u", record.Objects, record.Draws, record.Dispatches,
+		record.PipelineBinds, record.DescriptorBinds, record.Barriers, record.Copies, record.InputToPresent,
+		record.WindowsPresented);
+	for (u64 value : { record.Vertices, record.Triangles, record.MemoryUsage, record.MemoryBudget,
+			 record.GpuInputVertices, record.GpuInputPrimitives, record.GpuVertexInvocations,
+			 record.GpuClippingPrimitives, record.GpuFragmentInvocations, record.GpuComputeInvocations })
+	{
+		std::printf(",%llu", (unsigned long long)value);
+	}
+	std::printf("\n");
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::fprintf(stderr, "Usage: TelemetryToCsv <telemetry file> [--follow]\n");
+		return 1;
+	}
+
+	bool follow = argc > 2 && std::string_view(argv[2]) == "--follow";
+
+	std::ifstream file(argv[1], std::ios::binary);
+	Telemetry::FileHeader header;
+	if (!file || !ReadHeader(file, header))
+	{
+		std::fprintf(stderr, "Failed to read '%s'\n", argv[1]);
+		return 1;
+	}
+
+	if (header.Magic != Telemetry::Magic || header.Version != Telemetry::Version
+		|| header.HeaderSize != sizeof(Telemetry::FileHeader) || header.RecordSize != sizeof(Telemetry::FrameRecord)
+		|| header.Capacity == 0)
+	{
+		std::fprintf(stderr, "'%s' isn't a version %u telemetry file\n", argv[1], Telemetry::Version);
+		return 1;
+	}
+
+	u32 passCount = std::min(header.PassCount, Telemetry::MaxPasses);
+	PrintHeader(header);
+
+	// Starts at the oldest record still in the ring
+	u64 next = header.WriteCount > header.Capacity ? header.WriteCount - header.Capacity : 0;
+	std::vector<Telemetry::FrameRecord> records;
+	while (true)
+	{
+		if (!ReadHeader(file, header))
+		{
+			std::fprintf(stderr, "Failed to read '%s'\n", argv[1]);
+			return 1;
+		}
+
+		u64 end = header.WriteCount;
+		if (end - next > header.Capacity)
+		{
+			std::fprintf(stderr, "Skipped %llu overwritten records\n",
+				(unsigned long long)(end - header.Capacity - next));
+			next = end - header.Capacity;
+		}
+
+		records.resize(end - next);
+		for (u64 i = next; i < end; i++)
+		{
+			ReadRecord(file, header, i, records[i - next]);
+		}
+
+		// Anything the writer has started overwriting since is torn
+		if (!ReadHeader(file, header))
+		{
+			std::fprintf(stderr, "Failed to read '%s'\n", argv[1]);
+			return 1;
+		}
+
+		for (u64 i = next; i < end; i++)
+		{
+			if (header.WriteCount - i < header.Capacity)
+			{
+				PrintRecord(records[i - next], passCount);
+			}
+		}
+		next = end;
+		std::fflush(stdout);
+
+		if (!follow)
+		{
+			break;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+
+	return 0;
+}